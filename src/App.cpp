@@ -7,11 +7,18 @@
 #include "FileDialog.h"
 #include "Serialization.h"
 #include "ExportPly.h"
+#include "BackgroundJob.h"
 #include "ImportPly.h"
 #include "GpuSolver.h"
+#include "SimulationThread.h"
+#include "Parallel.h"
 #include "UserSettings.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "Log.h"
 
 #include "Raycast.h"
+#include "RootBinding.h"
 
 #include "HairToolVersion.h"
 
@@ -29,6 +36,7 @@
 #include <cstring>
 #include <unordered_map>
 
+App::App() = default;
 App::~App() = default;
 
 static void glfwErrorCallback(int error, const char* description) {
@@ -36,18 +44,25 @@ static void glfwErrorCallback(int error, const char* description) {
 }
 
 bool App::init() {
+	Trace::setThreadName("Main");
 	m_scene = std::make_unique<Scene>();
 	m_camera = std::make_unique<MayaCameraController>();
 	m_renderer = std::make_unique<Renderer>();
 
 	// Load persistent user settings early so we can restore window size before creating the window.
-	UserSettings::load(*m_scene, m_viewportBg, m_showControlsOverlay, m_showLayersPanel, m_uiScale, m_windowWidth, m_windowHeight, m_windowMaximized);
+	UserSettings::load(*m_scene, m_viewportBg, m_showControlsOverlay, m_showLayersPanel, m_uiScale, m_windowWidth, m_windowHeight, m_windowMaximized, m_autosaveEnabled, m_autosaveMinutes);
 
 	if (!initWindow()) return false;
 	if (!initGL()) return false;
 	if (!initImGui()) return false;
 
 	m_renderer->init();
+	m_simThread = std::make_unique<SimulationThread>();
+	m_simThread->start();
+	m_exportJob = std::make_unique<BackgroundJob>("PLY Export");
+	m_autosaveJob = std::make_unique<BackgroundJob>("Autosave");
+	m_autosaveSnapshot = std::make_unique<Serialization::SceneSnapshot>();
+	m_nextAutosaveTime = glfwGetTime() + std::max(1.0f, m_autosaveMinutes) * 60.0;
 	m_camera->setViewport(m_windowWidth, m_windowHeight);
 	m_camera->reset();
 	// Force style scaling to be applied on the first frame.
@@ -149,42 +164,60 @@ void App::run() {
 			m_camera->setViewport(w, h);
 		}
 
+		Profiler::beginFrame();
+
 		// Start UI frame early so input is up-to-date before simulation.
-		beginFrame();
-		if (m_toastTimeRemaining > 0.0f) {
-			m_toastTimeRemaining -= ImGui::GetIO().DeltaTime;
-			if (m_toastTimeRemaining <= 0.0f) {
-				m_toastTimeRemaining = 0.0f;
-				m_toastText.clear();
+		{
+			HT_PROFILE_SCOPE(Ui);
+			beginFrame();
+			if (m_toastTimeRemaining > 0.0f) {
+				m_toastTimeRemaining -= ImGui::GetIO().DeltaTime;
+				if (m_toastTimeRemaining <= 0.0f) {
+					m_toastTimeRemaining = 0.0f;
+					m_toastText.clear();
+				}
+			}
+			drawMenuBar();
+			drawSidePanel();
+			drawLayersPanel();
+			drawControlsOverlay();
+			drawGuideCounterOverlay();
+			drawProfilerOverlay();
+			pollExportJob();
+			pollAutosave();
+			drawToastOverlay();
+			handleViewportInput();
+			ImGui::Render();
+		}
+
+		{
+			HT_PROFILE_SCOPE(Tick);
+			m_scene->tick();
+		}
+		{
+			HT_PROFILE_SCOPE(Simulate);
+			const GuideSettings& gs = m_scene->guideSettings();
+			if (gs.simulationThread && !(gs.enableGpuSolver && GpuSolver::isAvailable())) {
+				// The solver runs on its own thread; pick up its latest state and hand it this frame's input.
+				m_simThread->sync(*m_scene);
+			} else {
+				m_simThread->reset();
+				m_scene->simulate(ImGui::GetIO().DeltaTime);
 			}
 		}
-		drawMenuBar();
-		drawSidePanel();
-		drawLayersPanel();
-		drawControlsOverlay();
-		drawGuideCounterOverlay();
-		drawToastOverlay();
-		handleViewportInput();
-		ImGui::Render();
-
-		m_scene->tick();
-		// Use YarnBall's timestep approach: max 1ms per substep for stability
-		const float dt = 1.0f / 60.0f;
-		const float maxSubstep = 0.001f;  // YarnBall's maxH
-		int substeps = (int)glm::ceil(dt / maxSubstep);
-		for (int i = 0; i < substeps; i++) {
-			m_scene->simulate(dt / (float)substeps);
-		}
-
-		// Render scene directly to main window framebuffer
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
-		glViewport(0, 0, w, h);
-		glClearColor(m_viewportBg[0], m_viewportBg[1], m_viewportBg[2], 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-		m_renderer->render(*m_scene, *m_camera);
-
-		// Draw ImGui overlay AFTER 3D rendering
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+
+		{
+			HT_PROFILE_SCOPE(Render);
+			// Render scene directly to main window framebuffer
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glViewport(0, 0, w, h);
+			glClearColor(m_viewportBg[0], m_viewportBg[1], m_viewportBg[2], 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			m_renderer->render(*m_scene, *m_camera);
+
+			// Draw ImGui overlay AFTER 3D rendering
+			ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		}
 		glfwSwapBuffers(m_window);
 	}
 }
@@ -211,6 +244,10 @@ void App::drawToastOverlay() {
 }
 
 void App::shutdown() {
+	if (m_simThread) m_simThread->stop();
+	if (m_exportJob && m_exportJob->isActive()) m_exportJob->finish(); // don't leave a half-written file
+	if (m_autosaveJob && m_autosaveJob->isActive()) m_autosaveJob->finish();
+
 	// Save persistent user settings before tearing down.
 	int w = m_windowWidth;
 	int h = m_windowHeight;
@@ -219,10 +256,11 @@ void App::shutdown() {
 		glfwGetWindowSize(m_window, &w, &h);
 		maximized = (glfwGetWindowAttrib(m_window, GLFW_MAXIMIZED) == GLFW_TRUE);
 	}
-	UserSettings::save(*m_scene, m_viewportBg, m_showControlsOverlay, m_showLayersPanel, m_uiScale, w, h, maximized);
+	UserSettings::save(*m_scene, m_viewportBg, m_showControlsOverlay, m_showLayersPanel, m_uiScale, w, h, maximized, m_autosaveEnabled, m_autosaveMinutes);
 	shutdownImGui();
 	if (m_window) glfwDestroyWindow(m_window);
 	glfwTerminate();
+	Trace::shutdown();
 }
 
 void App::beginFrame() {
@@ -253,7 +291,16 @@ void App::drawMenuBar() {
 			if (ImGui::MenuItem("Save Scene...")) actionSaveScene();
 			if (ImGui::MenuItem("Load Scene...")) actionLoadScene();
 			if (ImGui::MenuItem("Import Curves (PLY)...")) actionImportCurvesPly();
-			if (ImGui::MenuItem("Export Curves (PLY)...")) actionExportCurvesPly();
+			const bool exporting = m_exportJob->isActive();
+			if (ImGui::MenuItem("Export Curves (PLY)...", nullptr, false, !exporting)) actionExportCurvesPly();
+			if (ImGui::MenuItem("Export Curves (ASCII PLY)...", nullptr, false, !exporting)) actionExportCurvesPly(true);
+			ImGui::Separator();
+			ImGui::MenuItem("Autosave", nullptr, &m_autosaveEnabled);
+			if (m_autosaveEnabled) {
+				ImGui::SetNextItemWidth(140.0f * m_uiScale);
+				ImGui::SliderFloat("Every (min)", &m_autosaveMinutes, 1.0f, 30.0f, "%.0f");
+				if (ImGui::IsItemHovered()) ImGui::SetTooltip("%s", autosavePath().c_str());
+			}
 			ImGui::Separator();
 			if (ImGui::MenuItem("Quit")) m_shouldClose = true;
 			ImGui::EndMenu();
@@ -262,6 +309,7 @@ void App::drawMenuBar() {
 		if (ImGui::BeginMenu("View")) {
 			ImGui::MenuItem("Controls Help", nullptr, &m_showControlsOverlay);
 			ImGui::MenuItem("Layers Panel", nullptr, &m_showLayersPanel);
+			ImGui::MenuItem("Profiler", nullptr, &m_showProfilerOverlay);
 			if (ImGui::BeginMenu("UI Scale")) {
 				bool s1 = (m_uiScale == 1.0f);
 				bool s15 = (m_uiScale == 1.5f);
@@ -311,6 +359,15 @@ void App::drawGuideCounterOverlay() {
 	if (m_guideCounterAccum >= 1.0f) {
 		m_guideCounterAccum = 0.0f;
 		m_cachedGuideCount = (int)m_scene->guides().curveCount();
+		// Split the simulated set by solver sleep state.
+		m_cachedAwakeCount = 0;
+		m_cachedSleepingCount = 0;
+		const HairGuideSet& guides = m_scene->guides();
+		for (size_t ci = 0; ci < guides.curveCount(); ci++) {
+			if (!m_scene->isCurveSimulated(ci)) continue;
+			if (guides.curve(ci).sleep.sleeping) m_cachedSleepingCount++;
+			else m_cachedAwakeCount++;
+		}
 	}
 
 	ImGui::SetNextWindowPos(
@@ -323,6 +380,94 @@ void App::drawGuideCounterOverlay() {
 		ImGuiWindowFlags_NoNav | ImGuiWindowFlags_NoInputs;
 	if (ImGui::Begin("##GuideCounter", nullptr, flags)) {
 		ImGui::Text("Guides: %d", m_cachedGuideCount);
+		const GuideSettings& gs = m_scene->guideSettings();
+		if (gs.enableSimulation && gs.enableSleeping) {
+			ImGui::Text("Awake: %d  Sleeping: %d", m_cachedAwakeCount, m_cachedSleepingCount);
+		}
+	}
+	ImGui::End();
+}
+
+void App::drawProfilerOverlay() {
+	if (!m_showProfilerOverlay) return;
+
+	ImGuiViewport* vp = ImGui::GetMainViewport();
+	// Top-right, below the menu bar.
+	ImGui::SetNextWindowPos(ImVec2(vp->WorkPos.x + vp->WorkSize.x - 10.0f, vp->WorkPos.y + 10.0f), ImGuiCond_Always, ImVec2(1.0f, 0.0f));
+	ImGui::SetNextWindowBgAlpha(0.6f);
+	ImGuiWindowFlags flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_AlwaysAutoResize |
+		ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
+	if (!ImGui::Begin("##ProfilerOverlay", nullptr, flags)) {
+		ImGui::End();
+		return;
+	}
+
+	if (!Profiler::compiledIn()) {
+		ImGui::TextUnformatted("Profiler compiled out (HAIRTOOL_ENABLE_PROFILER=0)");
+		ImGui::End();
+		return;
+	}
+
+	Profiler::history(m_profilerHistory);
+	const size_t n = m_profilerHistory.size();
+	if (n == 0) {
+		ImGui::End();
+		return;
+	}
+
+	// Rolling window: last frame, mean and max over the recorded history.
+	double avg[Profiler::kPhaseCount] = {};
+	double peak[Profiler::kPhaseCount] = {};
+	double frameAvg = 0.0;
+	m_profilerFrameMs.resize(n);
+	for (size_t i = 0; i < n; i++) {
+		const Profiler::FrameStats& fs = m_profilerHistory[i];
+		frameAvg += fs.frameMs;
+		m_profilerFrameMs[i] = (float)fs.frameMs;
+		for (int p = 0; p < Profiler::kPhaseCount; p++) {
+			avg[p] += fs.phaseMs[p];
+			peak[p] = std::max(peak[p], fs.phaseMs[p]);
+		}
+	}
+	frameAvg /= (double)n;
+	for (int p = 0; p < Profiler::kPhaseCount; p++) avg[p] /= (double)n;
+	const Profiler::FrameStats& last = m_profilerHistory.back();
+
+	ImGui::Text("Frame %.2f ms (avg %.2f ms, %.0f fps)", last.frameMs, frameAvg, frameAvg > 0.0 ? 1000.0 / frameAvg : 0.0);
+	ImGui::PlotLines("##FrameMs", m_profilerFrameMs.data(), (int)m_profilerFrameMs.size(), 0, nullptr, 0.0f, 50.0f, ImVec2(260.0f * m_uiScale, 40.0f * m_uiScale));
+	ImGui::Separator();
+	ImGui::Text("%-18s %7s %7s %7s", "Phase", "last", "avg", "max");
+	for (int p = 0; p < Profiler::kPhaseCount; p++) {
+		const Profiler::Phase phase = (Profiler::Phase)p;
+		const char* indent = (Profiler::phaseDepth(phase) > 0) ? "  " : "";
+		ImGui::Text("%s%-*s %7.2f %7.2f %7.2f", indent, 18 - (int)std::strlen(indent), Profiler::phaseName(phase), last.phaseMs[p], avg[p], peak[p]);
+	}
+	if (const Mesh* mesh = m_scene->mesh()) {
+		// Built once at load, so shown as a one-off cost rather than per frame.
+		const Mesh::TopologyStats& ts = mesh->topologyStats();
+		ImGui::Separator();
+		ImGui::Text("Mesh topology %.2f ms, %.1f KB", ts.buildMs, (double)ts.bytes / 1024.0);
+		if (ImGui::IsItemHovered()) {
+			ImGui::SetTooltip("%zu welded vertices, %zu open edges, %zu non-manifold", ts.weldedVertices, ts.openEdges, ts.nonManifoldEdges);
+		}
+	}
+	ImGui::Separator();
+	bool tracing = Trace::enabled();
+	if (ImGui::Checkbox("Record trace", &tracing)) Trace::setEnabled(tracing);
+	ImGui::SameLine();
+	if (ImGui::Button("Clear")) Trace::clear();
+	ImGui::SameLine();
+	if (ImGui::Button("Dump Chrome Trace...")) {
+		std::string path;
+		if (FileDialog::saveFile(path, "Chrome Trace (*.json)\0*.json\0All Files\0*.*\0")) {
+			if (std::filesystem::path(path).extension().empty()) path += ".json";
+			std::string err;
+			if (Trace::writeChromeTrace(path, &err)) {
+				showToast(std::string("Wrote trace (") + path + ")");
+			} else {
+				showToast(std::string("Trace dump failed: ") + err, 4.0f);
+			}
+		}
 	}
 	ImGui::End();
 }
@@ -431,6 +576,7 @@ void App::drawSidePanel() {
 	ImGui::Checkbox("Mirror mode", &gs.mirrorMode);
 	if (lengthChanged || stepsChanged) {
 		m_scene->guides().applyLengthStepsToSelected(gs.defaultLength, gs.defaultSteps);
+		if (m_scene->mesh()) m_scene->guides().captureRestShapeSelected(*m_scene->mesh());
 	}
 	
 	ImGui::Spacing();
@@ -438,7 +584,49 @@ void App::drawSidePanel() {
 	ImGui::Separator();
 	ImGui::Checkbox("Enable Physics Simulation", &gs.enableSimulation);
 	// GPU solver toggle intentionally hidden for now (CPU is the primary workflow)
+	ImGui::Checkbox("Simulation Thread", &gs.simulationThread);
+	if (ImGui::Checkbox("Simulate All Guides", &gs.simulateAll)) {
+		m_scene->markSimulatedSetChanged();
+	}
+	if (ImGui::IsItemHovered()) {
+		ImGui::SetTooltip("Simulate every guide on a layer marked S in the Layers panel, not just the selection.");
+	}
+	ImGui::SliderFloat("Solver Budget", &gs.solverBudgetMs, 1.0f, 33.0f, "%.1f ms/frame");
+	ImGui::Checkbox("Adaptive Quality", &gs.adaptiveSolver);
+	if (ImGui::IsItemHovered()) {
+		ImGui::SetTooltip("Lower solver iterations while the scene overruns the budget, and raise them back when it fits.");
+	}
+	ImGui::Checkbox("Sleep Settled Guides", &gs.enableSleeping);
+	if (ImGui::IsItemHovered()) {
+		ImGui::SetTooltip("Skip guides that have come to rest until they are dragged, edited, pushed or their root moves.");
+	}
+	if (gs.enableSleeping) {
+		ImGui::SliderFloat("Sleep Threshold", &gs.sleepThreshold, 1e-7f, 1e-3f, "%.1e J/kg", ImGuiSliderFlags_Logarithmic);
+	}
+	if (gs.enableSimulation) {
+		const bool threaded = m_simThread && m_simThread->isActive();
+		const SimScheduler::Stats st = threaded ? m_simThread->stats() : m_scene->scheduler().stats();
+		if (st.stepsPerSecond > 0.0f) {
+			ImGui::TextDisabled("%.0f steps/s, %.2f ms/step, %d iters, stretch %.2f%%%s",
+				st.stepsPerSecond, st.stepCostMs, st.iterations, st.stretchError * 100.0f,
+				st.budgetLimited ? " (over budget)" : "");
+			ImGui::TextDisabled("%.2fM particle-steps/s on %d threads", st.particleStepsPerSecond * 1e-6f, Parallel::threadCount());
+			const int total = st.awakeCurves + st.sleepingCurves;
+			if (gs.enableSleeping && total > 0) {
+				// Settle progress: the share of the simulated guides that have come to rest.
+				char label[64];
+				std::snprintf(label, sizeof(label), "%d / %d settled", st.sleepingCurves, total);
+				ImGui::ProgressBar((float)st.sleepingCurves / (float)total, ImVec2(-1.0f, 0.0f), label);
+			}
+		}
+	}
 	ImGui::Checkbox("Enable Mesh Collision", &gs.enableMeshCollision);
+	if (gs.enableMeshCollision) {
+		ImGui::Checkbox("Continuous Collision", &gs.continuousCollision);
+		if (ImGui::IsItemHovered()) {
+			ImGui::SetTooltip("Catch guides that move through the mesh within one step (fast drags, thin ears).");
+		}
+	}
 	ImGui::Checkbox("Enable Curve Collision", &gs.enableCurveCollision);
 	ImGui::SliderFloat("Collision Thickness", &gs.collisionThickness, 0.0001f, 0.02f, "%.4f m");
 	ImGui::SliderFloat("Friction", &gs.collisionFriction, 0.0f, 1.0f, "%.2f");
@@ -448,7 +636,37 @@ void App::drawSidePanel() {
 	if (ImGui::SliderFloat("Damping", &dampingAmount, 0.0f, 1.0f, "%.3f")) {
 		gs.damping = 1.0f - glm::clamp(dampingAmount, 0.0f, 1.0f);
 	}
-	ImGui::SliderFloat("Bend Stiffness", &gs.stiffness, 0.0f, 1.0f, "%.2f");
+	ImGui::Checkbox("Rod Bending", &gs.rodBending);
+	if (ImGui::IsItemHovered()) {
+		ImGui::SetTooltip("Bend toward each guide's rest shape (captured on create/import) so curls and styling hold.");
+	}
+	if (gs.rodBending) {
+		ImGui::SliderFloat("Shape Stiffness", &gs.shapeStiffness, 0.0f, 1.0f, "%.2f");
+		ImGui::SliderFloat("Shape Hold", &gs.shapeHold, 0.0f, 0.5f, "%.3f");
+		if (ImGui::IsItemHovered()) {
+			ImGui::SetTooltip("Pull toward the rest pose relative to the root. Keeps long styled guides from sagging.");
+		}
+		const bool hasSelection = !m_scene->guides().selectedCurves().empty();
+		if (!hasSelection || !m_scene->mesh()) ImGui::BeginDisabled();
+		if (ImGui::Button("Set Rest Shape From Selected")) {
+			m_scene->guides().captureRestShapeSelected(*m_scene->mesh());
+			showToast("Rest shape updated");
+		}
+		if (!hasSelection || !m_scene->mesh()) ImGui::EndDisabled();
+	}
+	ImGui::Checkbox("Direct Stretch Solve", &gs.directStretchSolve);
+	if (ImGui::IsItemHovered()) {
+		ImGui::SetTooltip("Solve each guide's length constraints together (tridiagonal Newton step) instead of one at a time. Converges in fewer iterations on long guides.");
+	}
+	ImGui::Checkbox("XPBD Bending", &gs.useXpbd);
+	if (ImGui::IsItemHovered()) {
+		ImGui::SetTooltip("Bend stiffness from a physical compliance; stays the same when iterations or substeps change.");
+	}
+	if (gs.useXpbd) {
+		ImGui::SliderFloat("Bend Compliance", &gs.bendCompliance, 1e-8f, 1e-2f, "%.1e", ImGuiSliderFlags_Logarithmic);
+	} else {
+		ImGui::SliderFloat("Bend Stiffness", &gs.stiffness, 0.0f, 1.0f, "%.2f");
+	}
 	float dragSmooth = 1.0f - glm::clamp(gs.dragLerp, 0.0f, 1.0f);
 	if (ImGui::SliderFloat("Drag Smooth", &dragSmooth, 0.0f, 1.0f, "%.2f")) {
 		gs.dragLerp = 1.0f - glm::clamp(dragSmooth, 0.0f, 1.0f);
@@ -522,8 +740,9 @@ void App::drawLayersPanel() {
 
 	ImGui::Separator();
 
-	if (ImGui::BeginTable("LayersTable", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit)) {
+	if (ImGui::BeginTable("LayersTable", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit)) {
 		ImGui::TableSetupColumn("V", ImGuiTableColumnFlags_WidthFixed, 26.0f);
+		ImGui::TableSetupColumn("S", ImGuiTableColumnFlags_WidthFixed, 26.0f);
 		ImGui::TableSetupColumn("C", ImGuiTableColumnFlags_WidthFixed, 30.0f);
 		ImGui::TableSetupColumn("Layer", ImGuiTableColumnFlags_WidthStretch);
 		for (int li = (int)m_scene->layerCount() - 1; li >= 0; li--) {
@@ -540,12 +759,20 @@ void App::drawLayersPanel() {
 			}
 
 			ImGui::TableSetColumnIndex(1);
+			if (ImGui::SmallButton(layer.simulate ? "S" : " ")) {
+				m_scene->setLayerSimulated((int)i, !layer.simulate);
+			}
+			if (ImGui::IsItemHovered()) {
+				ImGui::SetTooltip(layer.simulate ? "Exclude from Simulate All Guides" : "Include in Simulate All Guides");
+			}
+
+			ImGui::TableSetColumnIndex(2);
 			float col[3] = { layer.color.r, layer.color.g, layer.color.b };
 			if (ImGui::ColorEdit3("##layercolor", col, ImGuiColorEditFlags_NoInputs)) {
 				m_scene->setLayerColor((int)i, glm::vec3(col[0], col[1], col[2]));
 			}
 
-			ImGui::TableSetColumnIndex(2);
+			ImGui::TableSetColumnIndex(3);
 			const bool active = ((int)i == m_scene->activeLayer());
 			if (m_layerRenameId == (int)i) {
 				ImGuiInputTextFlags flags = ImGuiInputTextFlags_AutoSelectAll | ImGuiInputTextFlags_EnterReturnsTrue;
@@ -642,17 +869,18 @@ void App::actionImportObj() {
 
 void App::actionSaveScene() {
 	std::string path;
-	if (!FileDialog::saveFile(path, "Scene Files\0*.json\0All Files\0*.*\0")) return;
-	// Ensure the file has a .json extension (Windows file dialog can return paths without extension).
+	if (!FileDialog::saveFile(path, "HairTool Scene (*.hts)\0*.hts\0JSON Scene (*.json)\0*.json\0All Files\0*.*\0")) return;
+	// Ensure the file has a scene extension (Windows file dialog can return paths without extension).
+	// Binary .hts is the default; .json is kept for interchange.
 	{
 		std::filesystem::path p(path);
 		std::string ext = p.extension().string();
 		std::string extLower = ext;
 		std::transform(extLower.begin(), extLower.end(), extLower.begin(), [](unsigned char c) { return (char)std::tolower(c); });
 		if (extLower.empty()) {
-			p += ".json";
-		} else if (extLower != ".json") {
-			p.replace_extension(".json");
+			p += ".hts";
+		} else if (extLower != ".hts" && extLower != ".json") {
+			p.replace_extension(".hts");
 		}
 		path = p.string();
 	}
@@ -662,7 +890,7 @@ void App::actionSaveScene() {
 
 void App::actionLoadScene() {
 	std::string path;
-	if (!FileDialog::openFile(path, "Scene Files\0*.json\0All Files\0*.*\0")) return;
+	if (!FileDialog::openFile(path, "Scene Files\0*.hts;*.json\0All Files\0*.*\0")) return;
 	m_lastScenePath = path;
 	bool cameraRestored = false;
 	Serialization::loadScene(*m_scene, m_camera.get(), path, &cameraRestored);
@@ -698,7 +926,7 @@ void App::actionImportCurvesPly() {
 		path = p.string();
 	}
 
-	std::vector<ImportPly::ImportedCurve> curves;
+	ImportPly::ImportedCurves curves;
 	std::vector<ImportPly::ImportedLayer> importedLayers;
 	bool hasLayerInfo = false;
 	std::string err;
@@ -707,7 +935,7 @@ void App::actionImportCurvesPly() {
 		return;
 	}
 
-	if (!m_scene->mesh()) {
+	if (!m_scene->mesh() || !m_scene->meshBvh()) {
 		showToast("Import Curves failed: no mesh loaded");
 		return;
 	}
@@ -753,8 +981,7 @@ void App::actionImportCurvesPly() {
 			}
 		} else {
 			// Only layer_id was present: ensure layers exist by id.
-			for (const auto& ic : curves) {
-				int lid = ic.layerId;
+			for (int lid : curves.layerId) {
 				if (lid < 0) lid = 0;
 				while (m_scene->layerCount() <= (size_t)lid) {
 					glm::vec3 col = m_scene->generateDistinctLayerColor();
@@ -775,6 +1002,8 @@ void App::actionImportCurvesPly() {
 		existingCurves.push_back((int)ci);
 		existingRoots.push_back(c.points[0]);
 	}
+	RootBinding::DuplicateIndex duplicates;
+	duplicates.build(existingRoots, dupRootTol);
 	std::vector<int> removeExisting;
 
 	int droppedNoBinding = 0;
@@ -786,27 +1015,34 @@ void App::actionImportCurvesPly() {
 	// so importing curves against a significantly different mesh drops unbindable strands.
 	const float maxBindDist = std::max(0.005f, gs.collisionThickness * 2.0f);
 
-	for (const auto& ic : curves) {
-		if (ic.points.size() < 2) {
+	// Bind all roots up front; the nearest-surface queries run in parallel on the scene's BVH.
+	auto rootIndexOf = [&](size_t ic) -> int {
+		const int anchorIndex = curves.anchorIndex[ic];
+		return (anchorIndex >= 0 && (size_t)anchorIndex < curves.pointCount(ic)) ? anchorIndex : 0;
+	};
+	std::vector<glm::vec3> importRoots(curves.curveCount(), glm::vec3(0.0f));
+	for (size_t ic = 0; ic < curves.curveCount(); ic++) {
+		if (curves.pointCount(ic) >= 2) importRoots[ic] = curves.curvePoints(ic)[rootIndexOf(ic)];
+	}
+	std::vector<RayHit> rootHits;
+	RootBinding::bindRoots(mesh, *m_scene->meshBvh(), importRoots, maxBindDist, rootHits);
+
+	std::vector<HairCurve> newCurves;
+	newCurves.reserve(curves.curveCount());
+	for (size_t ic = 0; ic < curves.curveCount(); ic++) {
+		const size_t pointCount = curves.pointCount(ic);
+		if (pointCount < 2) {
 			droppedInvalid++;
 			continue;
 		}
-		int rootIdx = (ic.anchorIndex >= 0 && (size_t)ic.anchorIndex < ic.points.size()) ? ic.anchorIndex : 0;
-		std::vector<glm::vec3> pts = ic.points;
-		if (rootIdx != 0) {
-			// Ensure the root is point[0] (HairTool treats index 0 as the pinned root).
-			std::rotate(pts.begin(), pts.begin() + rootIdx, pts.end());
-			rootIdx = 0;
-		}
-		glm::vec3 rootPos = pts[(size_t)rootIdx];
-
-		RayHit hit;
-		if (!Raycast::nearestOnMesh(mesh, rootPos, hit, maxBindDist) || !hit.hit || hit.triIndex < 0) {
+		const RayHit& hit = rootHits[ic];
+		if (!hit.hit || hit.triIndex < 0) {
 			droppedNoBinding++;
 			continue;
 		}
+		const int rootIdx = rootIndexOf(ic);
 
-		int layerId = hasLayerInfo ? ic.layerId : activeLayer;
+		int layerId = hasLayerInfo ? curves.layerId[ic] : activeLayer;
 		if (layerId < 0) layerId = 0;
 		if (hasLayerInfo) {
 			auto it = importLayerIdMap.find(layerId);
@@ -822,41 +1058,35 @@ void App::actionImportCurvesPly() {
 		}
 
 		// Duplicate detection: if any existing curve has the same root, replace it.
-		for (size_t ei = 0; ei < existingCurves.size(); ei++) {
-			int existingIdx = existingCurves[ei];
-			if (existingIdx < 0) continue;
-			if (glm::length(existingRoots[ei] - hit.position) <= dupRootTol) {
-				removeExisting.push_back(existingIdx);
-				existingCurves[ei] = -1;
-				break;
-			}
-		}
+		const int duplicate = duplicates.claim(hit.position);
+		if (duplicate >= 0) removeExisting.push_back(existingCurves[(size_t)duplicate]);
 
 		const LayerInfo& layer = m_scene->layer((size_t)layerId);
-		// Append via addCurveOnMesh (to preserve invariants), then overwrite with imported points.
-		m_scene->guides().addCurveOnMesh(mesh, hit.triIndex, hit.bary, hit.position, hit.normal, gs, layerId, layer.color, layer.visible);
-		HairCurve& dst = m_scene->guides().curve(m_scene->guides().curveCount() - 1);
-		dst.root.triIndex = hit.triIndex;
-		dst.root.bary = hit.bary;
-		dst.points = pts;
-		dst.prevPoints = pts;
+		HairCurve c;
+		c.root.triIndex = hit.triIndex;
+		c.root.bary = hit.bary;
+		c.layerId = layerId;
+		c.color = layer.color;
+		c.visible = layer.visible;
+		c.points.assign(curves.curvePoints(ic), curves.curvePoints(ic) + pointCount);
+		if (rootIdx != 0) {
+			// Ensure the root is point[0] (HairTool treats index 0 as the pinned root).
+			std::rotate(c.points.begin(), c.points.begin() + rootIdx, c.points.end());
+		}
 		// Snap the root to the bound mesh point.
-		if (!dst.points.empty()) {
-			dst.points[0] = hit.position;
-			dst.prevPoints[0] = hit.position;
-		}
-		if (dst.points.size() >= 2) {
-			float sum = 0.0f;
-			for (size_t si = 0; si + 1 < dst.points.size(); si++) sum += glm::length(dst.points[si + 1] - dst.points[si]);
-			if (sum <= 1e-6f) {
-				droppedInvalid++;
-				m_scene->guides().removeCurve((int)m_scene->guides().curveCount() - 1);
-				continue;
-			}
-			dst.segmentRestLen = sum / (float)(dst.points.size() - 1);
+		c.points[0] = hit.position;
+		float sum = 0.0f;
+		for (size_t si = 0; si + 1 < c.points.size(); si++) sum += glm::length(c.points[si + 1] - c.points[si]);
+		if (sum <= 1e-6f) {
+			droppedInvalid++;
+			continue;
 		}
+		c.segmentRestLen = sum / (float)(c.points.size() - 1);
+		// Imported shapes are the styling, so appendCurves captures them as the rest shape.
+		newCurves.push_back(std::move(c));
 		imported++;
 	}
+	m_scene->guides().appendCurves(mesh, std::move(newCurves));
 
 	if (!removeExisting.empty()) {
 		std::sort(removeExisting.begin(), removeExisting.end());
@@ -882,7 +1112,8 @@ void App::actionImportCurvesPly() {
 	}
 }
 
-void App::actionExportCurvesPly() {
+void App::actionExportCurvesPly(bool ascii) {
+	if (m_exportJob->isActive()) return; // one export at a time
 	std::string path;
 	if (!FileDialog::saveFile(path, "PLY Files\0*.ply\0All Files\0*.*\0")) return;
 	// Ensure the file has a .ply extension (Windows file dialog can return paths without extension).
@@ -899,6 +1130,84 @@ void App::actionExportCurvesPly() {
 		path = p.string();
 	}
 	m_lastPlyPath = path;
-	ExportPly::exportCurvesAsPointCloud(*m_scene, path);
-	showToast(std::string("Exported PLY (") + path + ")");
+	const ExportPly::Format format = ascii ? ExportPly::Format::Ascii : ExportPly::Format::BinaryLittleEndian;
+	// Only the copy of the curves happens here; formatting and writing run on the export thread so the
+	// UI stays interactive. pollExportJob reports progress and the result.
+	auto snapshot = std::make_shared<const ExportPly::Snapshot>(ExportPly::snapshotCurves(*m_scene));
+	m_exportPath = path;
+	m_exportJob->start([snapshot, path, format](std::atomic<float>& progress, std::string&) {
+		return ExportPly::writePointCloud(*snapshot, path, format, &progress);
+	});
+	pollExportJob();
+}
+
+void App::pollExportJob() {
+	if (!m_exportJob || !m_exportJob->isActive()) return;
+	if (!m_exportJob->isDone()) {
+		char text[64];
+		std::snprintf(text, sizeof(text), "Exporting PLY... %d%%", (int)(m_exportJob->progress() * 100.0f));
+		showToast(text, 0.5f);
+		return;
+	}
+	if (!m_exportJob->finish()) {
+		showToast(std::string("Export failed (") + m_exportPath + ")", 4.0f);
+		return;
+	}
+	showToast(std::string("Exported PLY (") + m_exportPath + ")");
+}
+
+std::string App::autosavePath() const {
+	// Next to the scene being worked on, otherwise beside the user settings.
+	if (!m_lastScenePath.empty()) {
+		std::filesystem::path p(m_lastScenePath);
+		return (p.parent_path() / (p.stem().string() + ".autosave.hts")).string();
+	}
+	return (std::filesystem::path(UserSettings::settingsPath()).parent_path() / "autosave.hts").string();
+}
+
+void App::pollAutosave() {
+	if (!m_autosaveJob) return;
+	if (m_autosaveJob->isActive()) {
+		if (!m_autosaveJob->isDone()) return;
+		std::string error;
+		if (!m_autosaveJob->finish(&error)) {
+			HT_ERR("ERROR: Autosave to %s failed: %s\n", m_autosaveTarget.c_str(), error.c_str());
+			showToast(std::string("Autosave failed (") + m_autosaveTarget + ")", 4.0f);
+		}
+		return;
+	}
+	if (!m_autosaveEnabled || !m_scene->mesh()) return;
+	const double now = glfwGetTime();
+	if (now < m_nextAutosaveTime) return;
+	m_nextAutosaveTime = now + std::max(1.0f, m_autosaveMinutes) * 60.0;
+
+	// The copy is the only part on the UI thread. The job hashes it and skips the write if the scene
+	// is unchanged since the last autosave; otherwise it writes a temp file and renames it over the
+	// previous autosave, so a crash mid-write never leaves a truncated file behind.
+	HT_TRACE_SCOPE("App::autosaveSnapshot");
+	Serialization::snapshotScene(*m_scene, *m_camera, *m_autosaveSnapshot);
+	m_autosaveTarget = autosavePath();
+	const Serialization::SceneSnapshot* snapshot = m_autosaveSnapshot.get();
+	const std::string path = m_autosaveTarget;
+	m_autosaveJob->start([this, snapshot, path](std::atomic<float>&, std::string& error) {
+		const uint64_t hash = snapshot->hash() ^ std::hash<std::string>()(path);
+		if (hash == m_autosaveHash) return true;
+		std::error_code ec;
+		std::filesystem::create_directories(std::filesystem::path(path).parent_path(), ec);
+		const std::string tmpPath = path + ".tmp";
+		if (!Serialization::writeSceneBinary(*snapshot, tmpPath)) {
+			std::filesystem::remove(tmpPath, ec);
+			error = "write failed";
+			return false;
+		}
+		std::filesystem::rename(tmpPath, path, ec);
+		if (ec) {
+			error = ec.message();
+			std::filesystem::remove(tmpPath, ec);
+			return false;
+		}
+		m_autosaveHash = hash;
+		HT_LOG("Autosaved %s\n", path.c_str());
+		return true;
+	});
 }
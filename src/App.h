@@ -3,16 +3,22 @@
 #include <string>
 #include <memory>
 #include <array>
+#include <vector>
+
+#include "Profiler.h"
 
 struct GLFWwindow;
 
 class Renderer;
 class Scene;
 class MayaCameraController;
+class SimulationThread;
+class BackgroundJob;
+namespace Serialization { struct SceneSnapshot; }
 
 class App {
 public:
-	App() = default;
+	App();
 	~App();
 	bool init();
 	void run();
@@ -32,16 +38,20 @@ private:
 	void drawLayersPanel();
 	void drawControlsOverlay();
 	void drawGuideCounterOverlay();
+	void drawProfilerOverlay();
 	void drawToastOverlay();
 	void handleViewportInput();
 	void resetSettingsToDefaults();
 	void showToast(const std::string& text, float seconds = 2.0f);
+	void pollExportJob();
+	void pollAutosave();
+	std::string autosavePath() const;
 
 	void actionImportObj();
 	void actionSaveScene();
 	void actionLoadScene();
 	void actionImportCurvesPly();
-	void actionExportCurvesPly();
+	void actionExportCurvesPly(bool ascii = false);
 
 	GLFWwindow* m_window = nullptr;
 	int m_windowWidth = 1600;
@@ -53,10 +63,25 @@ private:
 	std::unique_ptr<Renderer> m_renderer;
 	std::unique_ptr<Scene> m_scene;
 	std::unique_ptr<MayaCameraController> m_camera;
+	std::unique_ptr<SimulationThread> m_simThread;
+	std::unique_ptr<BackgroundJob> m_exportJob; // PLY export writing off the UI thread
+	std::string m_exportPath;
+
+	// Autosave: the scene is copied into a reused snapshot on the UI thread and written on the job's
+	// thread. m_autosaveHash is the content hash of the file on disk; only the running job writes it.
+	// The job is declared last so it is joined before the state its task uses is destroyed.
+	std::unique_ptr<Serialization::SceneSnapshot> m_autosaveSnapshot;
+	std::string m_autosaveTarget;
+	uint64_t m_autosaveHash = 0;
+	bool m_autosaveEnabled = true;
+	float m_autosaveMinutes = 5.0f;
+	double m_nextAutosaveTime = 0.0;
+	std::unique_ptr<BackgroundJob> m_autosaveJob;
 
 	// UI state
 	bool m_showControlsOverlay = true;
 	bool m_showLayersPanel = true;
+	bool m_showProfilerOverlay = false;
 	float m_uiScale = 1.0f;
 	float m_uiScaleApplied = 1.0f;
 	std::string m_lastObjPath;
@@ -71,6 +96,8 @@ private:
 
 	// UI counters (throttled)
 	int m_cachedGuideCount = 0;
+	int m_cachedAwakeCount = 0;
+	int m_cachedSleepingCount = 0;
 	float m_guideCounterAccum = 0.0f;
 
 	// Selection-driven guide settings UI
@@ -78,6 +105,10 @@ private:
 	bool m_selectedLengthMixed = false;
 	bool m_selectedStepsMixed = false;
 
+	// Profiler overlay scratch (reused every frame)
+	std::vector<Profiler::FrameStats> m_profilerHistory;
+	std::vector<float> m_profilerFrameMs;
+
 	int m_layerRenameId = -1;
 	std::array<char, 64> m_layerRenameBuffer{};
 };
@@ -0,0 +1,61 @@
+#include "BackgroundJob.h"
+
+#include "Trace.h"
+
+BackgroundJob::~BackgroundJob() {
+	if (!m_thread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	m_thread.join(); // a running task is finished first
+}
+
+bool BackgroundJob::start(Task task) {
+	if (m_active) return false;
+	m_active = true;
+	m_progress.store(0.0f, std::memory_order_relaxed);
+	m_done.store(false, std::memory_order_relaxed);
+	m_ok = false;
+	m_error.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_task = std::move(task);
+	}
+	if (!m_thread.joinable()) m_thread = std::thread([this]() { threadMain(); });
+	m_cv.notify_all();
+	return true;
+}
+
+bool BackgroundJob::finish(std::string* outError) {
+	if (!m_active) return false;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_cv.wait(lock, [&]() { return m_done.load(std::memory_order_acquire); });
+	}
+	m_active = false;
+	if (outError) *outError = m_error;
+	return m_ok;
+}
+
+void BackgroundJob::threadMain() {
+	Trace::setThreadName(m_threadName);
+	for (;;) {
+		Task task;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cv.wait(lock, [&]() { return m_stop || m_task; });
+			if (!m_task) return; // stopping with nothing queued
+			task = std::move(m_task);
+			m_task = nullptr;
+		}
+		m_ok = task(m_progress, m_error);
+		m_progress.store(1.0f, std::memory_order_relaxed);
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_done.store(true, std::memory_order_release);
+		}
+		m_cv.notify_all();
+	}
+}
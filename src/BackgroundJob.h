@@ -0,0 +1,48 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Runs one task at a time on a worker thread so long file writes don't stall the UI. The main thread
+// polls progress()/isDone() once per frame and collects the result with finish(). The worker is
+// started on first use and kept, so repeated jobs don't each register a new trace thread.
+class BackgroundJob {
+public:
+	// Returns success; may set error. progress is 0..1 and only read for display.
+	using Task = std::function<bool(std::atomic<float>& progress, std::string& error)>;
+
+	explicit BackgroundJob(const char* threadName = "BackgroundJob") : m_threadName(threadName) {}
+	~BackgroundJob();
+	BackgroundJob(const BackgroundJob&) = delete;
+	BackgroundJob& operator=(const BackgroundJob&) = delete;
+
+	// Returns false (and drops task) while a previous task hasn't been collected with finish().
+	bool start(Task task);
+
+	// True from start() until finish().
+	bool isActive() const { return m_active; }
+	bool isDone() const { return m_done.load(std::memory_order_acquire); }
+	float progress() const { return m_progress.load(std::memory_order_relaxed); }
+
+	// Waits for the task and returns its result.
+	bool finish(std::string* outError = nullptr);
+
+private:
+	void threadMain();
+
+	const char* m_threadName;
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	Task m_task;            // guarded by m_mutex; set by start, taken by the worker
+	bool m_stop = false;    // guarded by m_mutex
+	bool m_active = false;  // main thread only
+	std::atomic<float> m_progress{0.0f};
+	std::atomic<bool> m_done{false};
+	bool m_ok = false;      // written by the worker before m_done
+	std::string m_error;    // written by the worker before m_done
+};
@@ -1,10 +1,43 @@
 #include "Bvh.h"
 
 #include "Mesh.h"
+#include "Trace.h"
 
 #include <algorithm>
+#include <atomic>
 #include <limits>
 
+static thread_local Bvh::QueryStats t_queryStats;
+static std::atomic<uint32_t> s_nextBvhId{1};
+
+namespace {
+	// Counts traversal locally and folds it into the thread-local stats once per query.
+	struct QueryCounter {
+#if HAIRTOOL_ENABLE_PROFILER
+		explicit QueryCounter(bool ray) : m_ray(ray) {}
+		~QueryCounter() {
+			if (m_ray) t_queryStats.raycasts++;
+			else t_queryStats.nearestQueries++;
+			t_queryStats.nodesVisited += m_nodes;
+		}
+		void visit() { m_nodes++; }
+
+	private:
+		bool m_ray;
+		uint64_t m_nodes = 0;
+#else
+		explicit QueryCounter(bool) {}
+		void visit() {}
+#endif
+	};
+}
+
+static void countCachedQuery() {
+#if HAIRTOOL_ENABLE_PROFILER
+	t_queryStats.cachedQueries++;
+#endif
+}
+
 static glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c) {
 	// Real-Time Collision Detection (Christer Ericson) closest point on triangle
 	glm::vec3 ab = b - a;
@@ -48,6 +81,24 @@ static glm::vec3 closestPointOnTriangle(const glm::vec3& p, const glm::vec3& a,
 	return a + ab * v + ac * w;
 }
 
+// Moller-Trumbore, both faces; t is in units of rd.
+static bool segmentTriangle(const glm::vec3& ro, const glm::vec3& rd, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c, float& tOut) {
+	const glm::vec3 e1 = b - a;
+	const glm::vec3 e2 = c - a;
+	const glm::vec3 p = glm::cross(rd, e2);
+	const float det = glm::dot(e1, p);
+	if (glm::abs(det) < 1e-12f) return false;
+	const float invDet = 1.0f / det;
+	const glm::vec3 s = ro - a;
+	const float u = glm::dot(s, p) * invDet;
+	if (u < 0.0f || u > 1.0f) return false;
+	const glm::vec3 q = glm::cross(s, e1);
+	const float v = glm::dot(rd, q) * invDet;
+	if (v < 0.0f || u + v > 1.0f) return false;
+	tOut = glm::dot(e2, q) * invDet;
+	return true;
+}
+
 static void triBounds(const std::vector<glm::vec3>& pos, const std::vector<unsigned int>& ind, int triIndex, glm::vec3& outMin, glm::vec3& outMax) {
 	unsigned int i0 = ind[(size_t)triIndex * 3 + 0];
 	unsigned int i1 = ind[(size_t)triIndex * 3 + 1];
@@ -58,6 +109,7 @@ static void triBounds(const std::vector<glm::vec3>& pos, const std::vector<unsig
 
 void Bvh::build(const Mesh& mesh) {
 	m_mesh = &mesh;
+	m_id = s_nextBvhId++;
 	m_nodes.clear();
 	m_triIndices.clear();
 
@@ -156,6 +208,12 @@ float Bvh::aabbDistSq(const glm::vec3& p, const glm::vec3& bmin, const glm::vec3
 	return dx * dx + dy * dy + dz * dz;
 }
 
+Bvh::QueryStats Bvh::takeThreadQueryStats() {
+	QueryStats s = t_queryStats;
+	t_queryStats = QueryStats{};
+	return s;
+}
+
 void Bvh::raycast(const glm::vec3& ro, const glm::vec3& rd, const std::function<void(int)>& callback) const {
 	if (m_nodes.empty()) return;
 	glm::vec3 rdInv(1.0f / rd.x, 1.0f / rd.y, 1.0f / rd.z);
@@ -163,10 +221,12 @@ void Bvh::raycast(const glm::vec3& ro, const glm::vec3& rd, const std::function<
 	std::vector<int> stack;
 	stack.reserve(128);
 	stack.push_back(0);
+	QueryCounter counter(true);
 
 	while (!stack.empty()) {
 		int ni = stack.back();
 		stack.pop_back();
+		counter.visit();
 		const Node& n = m_nodes[(size_t)ni];
 		float tmin = 0, tmax = 0;
 		if (!rayAabb(ro, rdInv, n.bmin, n.bmax, tmin, tmax)) continue;
@@ -183,13 +243,62 @@ void Bvh::raycast(const glm::vec3& ro, const glm::vec3& rd, const std::function<
 	}
 }
 
-bool Bvh::nearestTriangle(const glm::vec3& p, int& outTriIndex, glm::vec3& outClosestPoint, glm::vec3& outNormal, float maxDist) const {
+bool Bvh::sweepSegment(const glm::vec3& a, const glm::vec3& b, int& outTriIndex, float& outT, glm::vec3& outNormal) const {
 	if (m_nodes.empty() || !m_mesh) return false;
 
 	const auto& pos = m_mesh->positions();
 	const auto& ind = m_mesh->indices();
 	if (pos.empty() || ind.empty()) return false;
 
+	const glm::vec3 rd = b - a;
+	const glm::vec3 rdInv(1.0f / rd.x, 1.0f / rd.y, 1.0f / rd.z);
+	float bestT = 1.0f;
+	int bestTri = -1;
+
+	// Same traversal as raycast, but bounded to the segment and shrinking to the closest hit so far.
+	int stack[64];
+	int sp = 0;
+	stack[sp++] = 0;
+	QueryCounter counter(true);
+
+	while (sp > 0) {
+		const Node& n = m_nodes[(size_t)stack[--sp]];
+		counter.visit();
+		float tmin = 0, tmax = 0;
+		if (!rayAabb(a, rdInv, n.bmin, n.bmax, tmin, tmax) || tmin > bestT) continue;
+
+		if (n.triCount > 0) {
+			for (int i = 0; i < n.triCount; i++) {
+				const int tri = m_triIndices[(size_t)n.firstTri + i];
+				float t = 0.0f;
+				if (!segmentTriangle(a, rd, pos[ind[(size_t)tri * 3 + 0]], pos[ind[(size_t)tri * 3 + 1]], pos[ind[(size_t)tri * 3 + 2]], t)) continue;
+				if (t < 0.0f || t > bestT) continue;
+				bestT = t;
+				bestTri = tri;
+			}
+			continue;
+		}
+
+		// Median splits keep the depth near log2(triangles / 8); 64 covers any mesh that fits in memory.
+		if (n.left >= 0 && sp < 64) stack[sp++] = n.left;
+		if (n.right >= 0 && sp < 64) stack[sp++] = n.right;
+	}
+
+	if (bestTri < 0) return false;
+	const glm::vec3& p0 = pos[ind[(size_t)bestTri * 3 + 0]];
+	const glm::vec3& p1 = pos[ind[(size_t)bestTri * 3 + 1]];
+	const glm::vec3& p2 = pos[ind[(size_t)bestTri * 3 + 2]];
+	outTriIndex = bestTri;
+	outT = bestT;
+	outNormal = glm::normalize(glm::cross(p1 - p0, p2 - p0));
+	return true;
+}
+
+template <class Skip>
+int Bvh::nearest(const glm::vec3& p, float maxDist, const Skip& skip, glm::vec3& outClosestPoint, glm::vec3& outNormal, float& outDistSq) const {
+	const auto& pos = m_mesh->positions();
+	const auto& ind = m_mesh->indices();
+
 	float bestDistSq = maxDist * maxDist;
 	int bestTri = -1;
 	glm::vec3 bestP(0.0f);
@@ -198,10 +307,12 @@ bool Bvh::nearestTriangle(const glm::vec3& p, int& outTriIndex, glm::vec3& outCl
 	std::vector<int> stack;
 	stack.reserve(128);
 	stack.push_back(0);
+	QueryCounter counter(false);
 
 	while (!stack.empty()) {
 		int ni = stack.back();
 		stack.pop_back();
+		counter.visit();
 		const Node& n = m_nodes[(size_t)ni];
 		float d2 = aabbDistSq(p, n.bmin, n.bmax);
 		if (d2 > bestDistSq) continue;
@@ -209,6 +320,7 @@ bool Bvh::nearestTriangle(const glm::vec3& p, int& outTriIndex, glm::vec3& outCl
 		if (n.triCount > 0) {
 			for (int i = 0; i < n.triCount; i++) {
 				int tri = m_triIndices[(size_t)n.firstTri + i];
+				if (skip(tri)) continue;
 				unsigned int i0 = ind[(size_t)tri * 3 + 0];
 				unsigned int i1 = ind[(size_t)tri * 3 + 1];
 				unsigned int i2 = ind[(size_t)tri * 3 + 2];
@@ -232,9 +344,117 @@ bool Bvh::nearestTriangle(const glm::vec3& p, int& outTriIndex, glm::vec3& outCl
 		if (n.right >= 0) stack.push_back(n.right);
 	}
 
-	if (bestTri < 0) return false;
-	outTriIndex = bestTri;
 	outClosestPoint = bestP;
 	outNormal = bestN;
+	outDistSq = bestDistSq;
+	return bestTri;
+}
+
+bool Bvh::nearestTriangle(const glm::vec3& p, int& outTriIndex, glm::vec3& outClosestPoint, glm::vec3& outNormal, float maxDist) const {
+	if (m_nodes.empty() || !m_mesh) return false;
+	if (m_mesh->positions().empty() || m_mesh->indices().empty()) return false;
+
+	glm::vec3 cp, n;
+	float distSq = 0.0f;
+	const int tri = nearest(p, maxDist, [](int) { return false; }, cp, n, distSq);
+	if (tri < 0) return false;
+	outTriIndex = tri;
+	outClosestPoint = cp;
+	outNormal = n;
 	return true;
 }
+
+bool Bvh::nearestTriangleCached(const glm::vec3& p, float maxDist, float margin, NearestCache& cache, int& outTriIndex, glm::vec3& outClosestPoint, glm::vec3& outNormal) const {
+	if (m_nodes.empty() || !m_mesh) return false;
+	const auto& pos = m_mesh->positions();
+	const auto& ind = m_mesh->indices();
+	const auto& weld = m_mesh->weldedVertices();
+	const auto& ringOffsets = m_mesh->vertexTriangleOffsets();
+	const auto& ring = m_mesh->vertexTriangles();
+	if (pos.empty() || ind.empty() || weld.size() != pos.size()) {
+		return nearestTriangle(p, outTriIndex, outClosestPoint, outNormal, maxDist);
+	}
+
+	// Triangles more than clearance from the anchor are more than clearance - moved from p, so while the
+	// best candidate is within that (or nothing can be within maxDist) the full query would agree.
+	for (int attempt = 0; attempt < 2; attempt++) {
+		const float moved = glm::length(p - cache.anchor);
+		if (cache.bvhId == m_id && moved <= margin) {
+			const float outside = cache.clearance - moved;
+			if (cache.tri < 0) {
+				if (outside >= maxDist) {
+					countCachedQuery();
+					return false;
+				}
+			} else {
+				const uint32_t v[3] = {weld[ind[(size_t)cache.tri * 3 + 0]], weld[ind[(size_t)cache.tri * 3 + 1]], weld[ind[(size_t)cache.tri * 3 + 2]]};
+				float bestDistSq = maxDist * maxDist;
+				int bestTri = -1;
+				glm::vec3 bestP(0.0f);
+				glm::vec3 bestN(0.0f, 1.0f, 0.0f);
+				for (int k = 0; k < 3; k++) {
+					for (uint32_t r = ringOffsets[v[k]]; r < ringOffsets[(size_t)v[k] + 1]; r++) {
+						const int tri = (int)ring[r];
+						const unsigned int i0 = ind[(size_t)tri * 3 + 0];
+						const unsigned int i1 = ind[(size_t)tri * 3 + 1];
+						const unsigned int i2 = ind[(size_t)tri * 3 + 2];
+						// Visit each triangle once: skip it under v[k] if it also has an earlier corner.
+						bool seen = false;
+						for (int j = 0; j < k; j++) seen = seen || weld[i0] == v[j] || weld[i1] == v[j] || weld[i2] == v[j];
+						if (seen) continue;
+						const glm::vec3 a = pos[i0];
+						const glm::vec3 b = pos[i1];
+						const glm::vec3 c = pos[i2];
+						const glm::vec3 cp = closestPointOnTriangle(p, a, b, c);
+						const glm::vec3 d = p - cp;
+						const float dd = glm::dot(d, d);
+						if (dd < bestDistSq) {
+							bestDistSq = dd;
+							bestTri = tri;
+							bestP = cp;
+							bestN = glm::normalize(glm::cross(b - a, c - a));
+						}
+					}
+				}
+				const float limit = glm::min(outside, maxDist);
+				if (bestTri >= 0 && bestDistSq <= limit * limit) {
+					countCachedQuery();
+					outTriIndex = bestTri;
+					outClosestPoint = bestP;
+					outNormal = bestN;
+					return true;
+				}
+				if (bestTri < 0 && outside >= maxDist) {
+					countCachedQuery();
+					return false;
+				}
+			}
+		}
+		if (attempt > 0) break;
+
+		// Refill: the nearest triangle within reach of any point inside the margin, then the closest
+		// triangle that doesn't share a vertex with it.
+		const float reach = maxDist + margin;
+		glm::vec3 cp, n;
+		float distSq = 0.0f;
+		cache.anchor = p;
+		cache.bvhId = m_id;
+		cache.tri = nearest(p, reach, [](int) { return false; }, cp, n, distSq);
+		cache.clearance = reach;
+		if (cache.tri >= 0) {
+			const uint32_t v0 = weld[ind[(size_t)cache.tri * 3 + 0]];
+			const uint32_t v1 = weld[ind[(size_t)cache.tri * 3 + 1]];
+			const uint32_t v2 = weld[ind[(size_t)cache.tri * 3 + 2]];
+			auto inRing = [&](int tri) {
+				for (int k = 0; k < 3; k++) {
+					const uint32_t vi = weld[ind[(size_t)tri * 3 + k]];
+					if (vi == v0 || vi == v1 || vi == v2) return true;
+				}
+				return false;
+			};
+			if (nearest(p, reach, inRing, cp, n, distSq) >= 0) cache.clearance = glm::sqrt(distSq);
+		}
+	}
+	// Unreachable in exact arithmetic (a fresh cache always answers); fall back to be safe.
+	return nearestTriangle(p, outTriIndex, outClosestPoint, outNormal, maxDist);
+}
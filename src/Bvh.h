@@ -2,6 +2,7 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <vector>
 #include <functional>
 
@@ -14,10 +15,46 @@ public:
 	// Calls callback(triIndex) for candidates hit by ray
 	void raycast(const glm::vec3& ro, const glm::vec3& rd, const std::function<void(int)>& callback) const;
 
+	// First triangle crossed by the segment a->b. outT is the hit's fraction along the segment [0..1],
+	// outNormal the triangle's unit geometric normal. Returns false if nothing is hit.
+	bool sweepSegment(const glm::vec3& a, const glm::vec3& b, int& outTriIndex, float& outT, glm::vec3& outNormal) const;
+
 	// Finds closest point on any triangle (within maxDist if provided).
 	// Returns false if BVH not built.
 	bool nearestTriangle(const glm::vec3& p, int& outTriIndex, glm::vec3& outClosestPoint, glm::vec3& outNormal, float maxDist = 1e30f) const;
 
+	// Per-particle memo for nearestTriangleCached. Value-initialised = empty.
+	struct NearestCache {
+		glm::vec3 anchor{0.0f};   // where the last full query ran
+		float clearance = 0.0f;   // distance from anchor to the closest triangle outside the candidates
+		int tri = -1;             // nearest triangle at anchor; candidates are the triangles sharing a vertex (-1 = none)
+		uint32_t bvhId = 0;       // build that filled it (0 = empty)
+	};
+
+	// Same result as nearestTriangle(p, ..., maxDist), but answered from the triangles around the cached
+	// nearest triangle while p stays within margin of the cache anchor and no triangle outside them can
+	// be closer. Otherwise runs the full query and refills the cache.
+	bool nearestTriangleCached(const glm::vec3& p, float maxDist, float margin, NearestCache& cache, int& outTriIndex, glm::vec3& outClosestPoint, glm::vec3& outNormal) const;
+
+	// Per-thread query counters for tracing (only counted when HAIRTOOL_ENABLE_PROFILER is on).
+	struct QueryStats {
+		uint64_t raycasts = 0;
+		uint64_t nearestQueries = 0;
+		uint64_t cachedQueries = 0;     // nearestTriangleCached calls answered without the tree
+		uint64_t nodesVisited = 0;
+
+		QueryStats& operator+=(const QueryStats& o) {
+			raycasts += o.raycasts;
+			nearestQueries += o.nearestQueries;
+			cachedQueries += o.cachedQueries;
+			nodesVisited += o.nodesVisited;
+			return *this;
+		}
+	};
+	// Returns the calling thread's counters since the last call and resets them. Code that queries from
+	// Parallel::forRange chunks has to collect them in each chunk.
+	static QueryStats takeThreadQueryStats();
+
 private:
 	struct Node {
 		glm::vec3 bmin{0}, bmax{0};
@@ -30,8 +67,10 @@ private:
 	std::vector<Node> m_nodes;
 	std::vector<int> m_triIndices;
 	const Mesh* m_mesh = nullptr;
+	uint32_t m_id = 0;
 
 	int buildNode(int first, int count);
+	template <class Skip> int nearest(const glm::vec3& p, float maxDist, const Skip& skip, glm::vec3& outClosestPoint, glm::vec3& outNormal, float& outDistSq) const;
 	static bool rayAabb(const glm::vec3& ro, const glm::vec3& rdInv, const glm::vec3& bmin, const glm::vec3& bmax, float& tminOut, float& tmaxOut);
 	static float aabbDistSq(const glm::vec3& p, const glm::vec3& bmin, const glm::vec3& bmax);
 };
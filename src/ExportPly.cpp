@@ -2,41 +2,95 @@
 
 #include "Scene.h"
 #include "HairGuides.h"
+#include "Trace.h"
 
 #include <fstream>
 #include <vector>
 #include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
 
-bool ExportPly::exportCurvesAsPointCloud(const Scene& scene, const std::string& path) {
+// Appends v in the file's byte order.
+template <class T>
+static void putBinary(std::vector<char>& out, T v, bool swap) {
+	char b[sizeof(T)];
+	std::memcpy(b, &v, sizeof(T));
+	if (swap) std::reverse(b, b + sizeof(T));
+	out.insert(out.end(), b, b + sizeof(T));
+}
+
+// Appends v as text. Floats use 6 significant digits in %g style, which is what the stream
+// formatting this replaced produced, so ASCII files are unchanged.
+static void putText(std::vector<char>& out, float v) {
+	char b[32];
+	const std::to_chars_result r = std::to_chars(b, b + sizeof(b), v, std::chars_format::general, 6);
+	out.insert(out.end(), b, r.ptr);
+}
+
+static void putText(std::vector<char>& out, int v) {
+	char b[16];
+	const std::to_chars_result r = std::to_chars(b, b + sizeof(b), v);
+	out.insert(out.end(), b, r.ptr);
+}
+
+ExportPly::Snapshot ExportPly::snapshotCurves(const Scene& scene) {
+	HT_TRACE_SCOPE("ExportPly::snapshotCurves");
 	// Single-file export that preserves per-curve control point counts.
 	// We emit per-vertex curve_id so importers can reconstruct variable-length strands.
+	Snapshot snap;
+	const HairGuideSet& guides = scene.guides();
+	size_t vertexCount = 0;
+	for (size_t ci = 0; ci < guides.curveCount(); ci++) {
+		const HairCurve& c = guides.curve(ci);
+		if (c.visible && c.points.size() >= 2) vertexCount += c.points.size();
+	}
+	snap.points.reserve(vertexCount);
 
-	std::vector<size_t> exportCurves;
 	std::vector<int> exportLayers;
-	size_t vertexCount = 0;
-	for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) {
-		const HairCurve& c = scene.guides().curve(ci);
-		if (!c.visible) continue;
-		if (c.points.size() >= 2) {
-			exportCurves.push_back(ci);
-			vertexCount += c.points.size();
-			if (std::find(exportLayers.begin(), exportLayers.end(), c.layerId) == exportLayers.end()) {
-				exportLayers.push_back(c.layerId);
-			}
+	for (size_t ci = 0; ci < guides.curveCount(); ci++) {
+		const HairCurve& c = guides.curve(ci);
+		if (!c.visible || c.points.size() < 2) continue;
+		snap.points.insert(snap.points.end(), c.points.begin(), c.points.end());
+		snap.offsets.push_back(snap.points.size());
+		snap.anchored.push_back(c.root.triIndex >= 0 ? 1 : 0);
+		snap.layerIds.push_back(c.layerId);
+		if (std::find(exportLayers.begin(), exportLayers.end(), c.layerId) == exportLayers.end()) {
+			exportLayers.push_back(c.layerId);
 		}
 	}
+
+	for (int layerId : exportLayers) {
+		if (layerId < 0 || layerId >= (int)scene.layerCount()) continue;
+		const LayerInfo& layer = scene.layer((size_t)layerId);
+		Snapshot::Layer l;
+		l.id = layerId;
+		l.name = layer.name;
+		l.color = layer.color;
+		l.visible = layer.visible;
+		snap.layers.push_back(l);
+	}
+	return snap;
+}
+
+bool ExportPly::writePointCloud(const Snapshot& snap, const std::string& path, Format format, std::atomic<float>* progress) {
+	HT_TRACE_SCOPE("ExportPly::writePointCloud");
+	const size_t vertexCount = snap.points.size();
 	if (vertexCount == 0) return false;
 
 	std::ofstream f(path, std::ios::binary);
 	if (!f.is_open()) return false;
 
 	f << "ply\n";
-	f << "format ascii 1.0\n";
+	switch (format) {
+	case Format::BinaryLittleEndian: f << "format binary_little_endian 1.0\n"; break;
+	case Format::BinaryBigEndian: f << "format binary_big_endian 1.0\n"; break;
+	case Format::Ascii: f << "format ascii 1.0\n"; break;
+	}
 	// Layer metadata for round-trip
-	for (int layerId : exportLayers) {
-		if (layerId < 0 || layerId >= (int)scene.layerCount()) continue;
-		const LayerInfo& layer = scene.layer((size_t)layerId);
-		f << "comment layer " << layerId << " \"" << layer.name << "\" "
+	for (const Snapshot::Layer& layer : snap.layers) {
+		f << "comment layer " << layer.id << " \"" << layer.name << "\" "
 		  << layer.color.r << " " << layer.color.g << " " << layer.color.b << " "
 		  << (layer.visible ? 1 : 0) << "\n";
 	}
@@ -49,16 +103,52 @@ bool ExportPly::exportCurvesAsPointCloud(const Scene& scene, const std::string&
 	f << "property int curve_id\n";
 	f << "end_header\n";
 
-	for (size_t ei = 0; ei < exportCurves.size(); ei++) {
-		size_t ci = exportCurves[ei];
-		const HairCurve& c = scene.guides().curve(ci);
-		if (c.points.size() < 2) continue;
-		for (size_t i = 0; i < c.points.size(); i++) {
-			const glm::vec3& p = c.points[i];
-			const int anchor = (i == 0 && c.root.triIndex >= 0) ? 1 : 0;
-			f << p.x << " " << p.y << " " << p.z << " " << anchor << " " << c.layerId << " " << (int)ei << "\n";
+	// Records are formatted into a large buffer that is written whenever it fills up.
+	// Binary records are 21 bytes: float x, y, z; uchar anchor; int layer_id; int curve_id.
+	const bool ascii = (format == Format::Ascii);
+	const bool swap = (format == Format::BinaryLittleEndian) != (std::endian::native == std::endian::little);
+	const size_t flushBytes = 1 << 20;
+	std::vector<char> buf;
+	buf.reserve(flushBytes + 256);
+	auto flush = [&](size_t written) {
+		f.write(buf.data(), (std::streamsize)buf.size());
+		buf.clear();
+		if (progress) progress->store((float)((double)written / (double)vertexCount), std::memory_order_relaxed);
+	};
+	for (size_t ci = 0; ci < snap.curveCount(); ci++) {
+		const int layerId = snap.layerIds[ci];
+		for (size_t i = snap.offsets[ci]; i < snap.offsets[ci + 1]; i++) {
+			const glm::vec3& p = snap.points[i];
+			const int anchor = (i == snap.offsets[ci] && snap.anchored[ci]) ? 1 : 0;
+			if (ascii) {
+				putText(buf, p.x);
+				buf.push_back(' ');
+				putText(buf, p.y);
+				buf.push_back(' ');
+				putText(buf, p.z);
+				buf.push_back(' ');
+				putText(buf, anchor);
+				buf.push_back(' ');
+				putText(buf, layerId);
+				buf.push_back(' ');
+				putText(buf, (int)ci);
+				buf.push_back('\n');
+			} else {
+				putBinary<float>(buf, p.x, swap);
+				putBinary<float>(buf, p.y, swap);
+				putBinary<float>(buf, p.z, swap);
+				putBinary<uint8_t>(buf, (uint8_t)anchor, swap);
+				putBinary<int32_t>(buf, layerId, swap);
+				putBinary<int32_t>(buf, (int32_t)ci, swap);
+			}
+			if (buf.size() >= flushBytes) flush(i + 1);
 		}
 	}
+	flush(vertexCount);
+	return f.good();
+}
 
-	return true;
+bool ExportPly::exportCurvesAsPointCloud(const Scene& scene, const std::string& path, Format format) {
+	HT_TRACE_SCOPE("ExportPly::exportCurvesAsPointCloud");
+	return writePointCloud(snapshotCurves(scene), path, format);
 }
@@ -1,9 +1,48 @@
 #pragma once
 
+#include <glm/glm.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 class Scene;
 
 namespace ExportPly {
-	bool exportCurvesAsPointCloud(const Scene& scene, const std::string& path);
+	enum class Format {
+		BinaryLittleEndian,
+		BinaryBigEndian,
+		Ascii,
+	};
+
+	// The exported curves copied out of the scene, so they can be written on another thread while the
+	// scene keeps changing. Curve i owns points[offsets[i], offsets[i + 1]).
+	struct Snapshot {
+		struct Layer {
+			int id = 0;
+			std::string name;
+			glm::vec3 color{0.0f};
+			bool visible = true;
+		};
+		std::vector<Layer> layers;        // layers used by the exported curves
+		std::vector<glm::vec3> points;
+		std::vector<size_t> offsets{0};
+		std::vector<uint8_t> anchored;    // per curve: root bound to the mesh, written as anchor = 1 on point 0
+		std::vector<int> layerIds;        // per curve
+
+		size_t curveCount() const { return layerIds.size(); }
+	};
+
+	// Copies the visible guides with at least two points.
+	Snapshot snapshotCurves(const Scene& scene);
+
+	// Writes one vertex element (x y z anchor layer_id curve_id) plus layer comments. Touches only the
+	// snapshot, so it may run on any thread; progress (0..1) is updated as buffers are flushed.
+	bool writePointCloud(const Snapshot& snapshot, const std::string& path, Format format, std::atomic<float>* progress = nullptr);
+
+	// snapshotCurves + writePointCloud on the calling thread.
+	// Binary is the default: a fraction of the size of ASCII and much faster to read back.
+	bool exportCurvesAsPointCloud(const Scene& scene, const std::string& path, Format format = Format::BinaryLittleEndian);
 }
@@ -0,0 +1,226 @@
+#include "GuideGenerator.h"
+
+#include "Scene.h"
+#include "Mesh.h"
+#include "Camera.h"
+#include "ImageLoader.h"
+#include "Serialization.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+namespace {
+	struct MaskImage {
+		int w = 0;
+		int h = 0;
+		std::vector<unsigned char> bgra;
+
+		bool valid() const { return w > 0 && h > 0 && bgra.size() >= (size_t)w * (size_t)h * 4u; }
+
+		// Nearest-texel brightness in [0,1]. UVs wrap like the viewport texture (GL_REPEAT).
+		// Mesh UVs are already V-flipped at import, so v maps directly to image rows.
+		float sample(const glm::vec2& uv) const {
+			float u = uv.x - std::floor(uv.x);
+			float v = uv.y - std::floor(uv.y);
+			int x = std::clamp((int)(u * (float)w), 0, w - 1);
+			int y = std::clamp((int)(v * (float)h), 0, h - 1);
+			const unsigned char* px = &bgra[((size_t)y * (size_t)w + (size_t)x) * 4u];
+			return ((float)px[0] + (float)px[1] + (float)px[2]) / (3.0f * 255.0f);
+		}
+	};
+
+	static glm::vec3 layerColor(int layerIdx) {
+		if (layerIdx == 0) return glm::vec3(0.90f, 0.75f, 0.22f);
+		// Golden-ratio hue sweep (HSV with s=0.65, v=0.95): deterministic and well separated.
+		float h = std::fmod((float)layerIdx * 0.61803398875f, 1.0f) * 6.0f;
+		int i = (int)std::floor(h);
+		float f = h - (float)i;
+		const float v = 0.95f, s = 0.65f;
+		float p = v * (1.0f - s), q = v * (1.0f - s * f), t = v * (1.0f - s * (1.0f - f));
+		switch (i) {
+			case 0: return glm::vec3(v, t, p);
+			case 1: return glm::vec3(q, v, p);
+			case 2: return glm::vec3(p, v, t);
+			case 3: return glm::vec3(p, q, v);
+			case 4: return glm::vec3(t, p, v);
+			default: return glm::vec3(v, p, q);
+		}
+	}
+}
+
+int GuideGenerator::scatter(Scene& scene, const Params& params, std::string* outError) {
+	if (outError) outError->clear();
+	const Mesh* meshPtr = scene.mesh();
+	if (!meshPtr) {
+		if (outError) *outError = "No mesh loaded";
+		return -1;
+	}
+	const Mesh& mesh = *meshPtr;
+	const auto& pos = mesh.positions();
+	const auto& nrm = mesh.normals();
+	const auto& uvs = mesh.uvs();
+	const auto& ind = mesh.indices();
+	const size_t triCount = ind.size() / 3;
+	if (triCount == 0) {
+		if (outError) *outError = "Mesh has no triangles";
+		return -1;
+	}
+
+	MaskImage mask;
+	if (!params.maskPath.empty()) {
+		if (uvs.size() != pos.size()) {
+			if (outError) *outError = "Mask requires a mesh with UVs";
+			return -1;
+		}
+		if (!ImageLoader::loadRGBA8(params.maskPath, mask.w, mask.h, mask.bgra) || !mask.valid()) {
+			if (outError) *outError = "Failed to load mask " + params.maskPath;
+			return -1;
+		}
+	}
+
+	// Triangle CDF weighted by area (and by the mask averaged over corners + centroid, so fully
+	// masked-out triangles are never picked and rejection sampling stays cheap).
+	std::vector<double> cdf(triCount);
+	double total = 0.0;
+	for (size_t t = 0; t < triCount; t++) {
+		const unsigned int i0 = ind[t * 3 + 0], i1 = ind[t * 3 + 1], i2 = ind[t * 3 + 2];
+		double w = 0.5 * (double)glm::length(glm::cross(pos[i1] - pos[i0], pos[i2] - pos[i0]));
+		if (mask.valid()) {
+			glm::vec2 c = (uvs[i0] + uvs[i1] + uvs[i2]) / 3.0f;
+			float m = 0.25f * (mask.sample(uvs[i0]) + mask.sample(uvs[i1]) + mask.sample(uvs[i2]) + mask.sample(c));
+			w *= (m > params.maskThreshold) ? (double)m : 0.0;
+		}
+		total += w;
+		cdf[t] = total;
+	}
+	if (total <= 0.0) {
+		if (outError) *outError = "Mask excludes the whole mesh";
+		return -1;
+	}
+
+	if (params.clearExisting) scene.clearCurves();
+
+	const int layerCount = std::clamp(params.layers, 1, 256);
+	if (params.clearExisting || (int)scene.layerCount() < layerCount) {
+		std::vector<LayerInfo> layers;
+		for (int li = 0; li < layerCount; li++) {
+			LayerInfo l;
+			l.name = "Layer " + std::to_string(li);
+			l.color = layerColor(li);
+			l.visible = true;
+			layers.push_back(l);
+		}
+		scene.setLayers(layers, 0);
+	}
+
+	GuideSettings gs = scene.guideSettings();
+	gs.defaultSteps = std::clamp(params.steps, 2, 256);
+
+	std::mt19937 rng(params.seed);
+	std::uniform_real_distribution<double> uni(0.0, 1.0);
+	const float jitter = glm::clamp(params.lengthJitter, 0.0f, 0.95f);
+	const int maxTries = 64;
+
+	int created = 0;
+	for (int gi = 0; gi < params.count; gi++) {
+		for (int attempt = 0; attempt < maxTries; attempt++) {
+			double r = uni(rng) * total;
+			size_t tri = (size_t)(std::lower_bound(cdf.begin(), cdf.end(), r) - cdf.begin());
+			if (tri >= triCount) tri = triCount - 1;
+
+			float u = (float)uni(rng);
+			float v = (float)uni(rng);
+			if (u + v > 1.0f) {
+				u = 1.0f - u;
+				v = 1.0f - v;
+			}
+			const glm::vec3 bary(1.0f - u - v, u, v);
+			const unsigned int i0 = ind[tri * 3 + 0], i1 = ind[tri * 3 + 1], i2 = ind[tri * 3 + 2];
+
+			if (mask.valid()) {
+				glm::vec2 uv = uvs[i0] * bary.x + uvs[i1] * bary.y + uvs[i2] * bary.z;
+				float m = mask.sample(uv);
+				if (m <= params.maskThreshold || uni(rng) > (double)m) continue;
+			}
+
+			glm::vec3 p = pos[i0] * bary.x + pos[i1] * bary.y + pos[i2] * bary.z;
+			glm::vec3 n = (nrm.size() == pos.size())
+				? (nrm[i0] * bary.x + nrm[i1] * bary.y + nrm[i2] * bary.z)
+				: glm::cross(pos[i1] - pos[i0], pos[i2] - pos[i0]);
+			gs.defaultLength = params.length * (1.0f + jitter * (float)(2.0 * uni(rng) - 1.0));
+
+			const int layerId = gi % layerCount;
+			const LayerInfo& layer = scene.layer((size_t)layerId);
+			if (scene.guides().addCurveOnMesh(mesh, (int)tri, bary, p, n, gs, layerId, layer.color, layer.visible) >= 0) {
+				created++;
+			}
+			break;
+		}
+	}
+	return created;
+}
+
+int GuideGenerator::runCommandLine(int argc, char** argv) {
+	std::string outPath;
+	std::string meshPath = "sample/test_head.obj";
+	Params params;
+	for (int i = 1; i < argc; i++) {
+		auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+		if (!std::strcmp(argv[i], "--generate")) outPath = next();
+		else if (!std::strcmp(argv[i], "--mesh")) meshPath = next();
+		else if (!std::strcmp(argv[i], "--guides")) params.count = std::atoi(next());
+		else if (!std::strcmp(argv[i], "--steps")) params.steps = std::atoi(next());
+		else if (!std::strcmp(argv[i], "--length")) params.length = (float)std::atof(next());
+		else if (!std::strcmp(argv[i], "--length-jitter")) params.lengthJitter = (float)std::atof(next());
+		else if (!std::strcmp(argv[i], "--layers")) params.layers = std::atoi(next());
+		else if (!std::strcmp(argv[i], "--mask")) params.maskPath = next();
+		else if (!std::strcmp(argv[i], "--mask-threshold")) params.maskThreshold = (float)std::atof(next());
+		else if (!std::strcmp(argv[i], "--seed")) params.seed = (uint32_t)std::strtoul(next(), nullptr, 10);
+		else {
+			std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+			outPath.clear();
+			break;
+		}
+	}
+	if (outPath.empty()) {
+		std::fprintf(stderr,
+			"Usage: HairTool --generate <out.hts|out.json> [--mesh head.obj] [--guides N] [--steps N] [--length m]\n"
+			"                [--length-jitter f] [--layers N] [--mask image] [--mask-threshold f] [--seed N]\n");
+		return 2;
+	}
+
+	Scene scene;
+	// Store an absolute mesh path so the generated scene loads from any working directory.
+	std::error_code ec;
+	std::filesystem::path absMesh = std::filesystem::absolute(meshPath, ec);
+	if (!scene.loadMeshFromObj(ec ? meshPath : absMesh.string())) {
+		std::fprintf(stderr, "Failed to load mesh %s\n", meshPath.c_str());
+		return 1;
+	}
+
+	const auto t0 = std::chrono::steady_clock::now();
+	std::string err;
+	int created = scatter(scene, params, &err);
+	if (created < 0) {
+		std::fprintf(stderr, "Generation failed: %s\n", err.c_str());
+		return 1;
+	}
+	const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+	Camera camera;
+	camera.reset();
+	camera.frameBounds(scene.meshBoundsMin(), scene.meshBoundsMax());
+	if (!Serialization::saveScene(scene, camera, outPath)) {
+		std::fprintf(stderr, "Failed to write %s\n", outPath.c_str());
+		return 1;
+	}
+	std::printf("Generated %d guides (%d requested) in %.1f ms -> %s\n", created, params.count, ms, outPath.c_str());
+	return 0;
+}
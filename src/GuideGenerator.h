@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+class Scene;
+
+// Procedural guide scattering for stress testing and benchmarks.
+namespace GuideGenerator {
+	struct Params {
+		int count = 10000;
+		int steps = 12;
+		float length = 0.3f;
+		float lengthJitter = 0.0f;    // +/- fraction of length, uniformly distributed
+		int layers = 1;               // guides are distributed round-robin over this many layers
+		uint32_t seed = 1;
+		// Optional density mask sampled in mesh UV space (e.g. sample/hair_mask.jpg).
+		// Brightness is the acceptance probability; texels below maskThreshold never grow hair.
+		std::string maskPath;
+		float maskThreshold = 0.05f;
+		bool clearExisting = true;
+	};
+
+	// Scatters params.count guides on the scene mesh using area-weighted sampling.
+	// The same params and mesh always produce the same groom.
+	// Returns the number of guides created, or -1 on error.
+	int scatter(Scene& scene, const Params& params, std::string* outError = nullptr);
+
+	// Headless entry point for `HairTool --generate <out.json> [options]`. Returns a process exit code.
+	int runCommandLine(int argc, char** argv);
+}
@@ -2,6 +2,7 @@
 
 #include "Mesh.h"
 #include "Log.h"
+#include "Profiler.h"
 
 #include <glad/glad.h>
 #include <glm/gtc/type_ptr.hpp>
@@ -9,10 +10,35 @@
 #include <vector>
 #include <limits>
 
+// Clamps and renormalizes the barycentrics of a binding on a valid triangle; otherwise unpins it.
+// Returns false if the triangle index was invalid.
+static bool sanitizeRootBinding(HairRootBinding& root, size_t triCount) {
+	if (root.triIndex < 0 || (size_t)root.triIndex >= triCount) {
+		root.triIndex = -1;
+		root.bary = glm::vec3(1.0f, 0.0f, 0.0f);
+		return false;
+	}
+	glm::vec3 b = root.bary;
+	if (glm::any(glm::isnan(b)) || glm::any(glm::isinf(b))) {
+		b = glm::vec3(1.0f, 0.0f, 0.0f);
+	}
+	// Clamp and renormalize barycentrics to avoid drift.
+	b = glm::clamp(b, glm::vec3(0.0f), glm::vec3(1.0f));
+	float s = b.x + b.y + b.z;
+	if (s <= 1e-8f) {
+		b = glm::vec3(1.0f, 0.0f, 0.0f);
+	} else {
+		b /= s;
+	}
+	root.bary = b;
+	return true;
+}
+
 void HairGuideSet::clear() {
 	m_curves.clear();
 	m_selected.clear();
 	m_activeCurve = -1;
+	m_revision++;
 }
 
 int HairGuideSet::addCurveOnMesh(const Mesh& mesh, int triIndex, const glm::vec3& bary, const glm::vec3& hitPos, const glm::vec3& hitNormal, const GuideSettings& settings, int layerId, const glm::vec3& color, bool visible) {
@@ -24,26 +50,10 @@ int HairGuideSet::addCurveOnMesh(const Mesh& mesh, int triIndex, const glm::vec3
 	// If the triangle index is invalid, we still allow spawning (unpinned root),
 	// but we must not use it during physics.
 	{
-		const auto& ind = mesh.indices();
-		const size_t triCount = ind.size() / 3;
-		if (triIndex >= 0 && (size_t)triIndex < triCount) {
-			c.root.triIndex = triIndex;
-			glm::vec3 b = bary;
-			if (glm::any(glm::isnan(b)) || glm::any(glm::isinf(b))) {
-				b = glm::vec3(1.0f, 0.0f, 0.0f);
-			}
-			// Clamp and renormalize barycentrics to avoid drift.
-			b = glm::clamp(b, glm::vec3(0.0f), glm::vec3(1.0f));
-			float s = b.x + b.y + b.z;
-			if (s <= 1e-8f) {
-				b = glm::vec3(1.0f, 0.0f, 0.0f);
-			} else {
-				b /= s;
-			}
-			c.root.bary = b;
-		} else {
-			c.root.triIndex = -1;
-			c.root.bary = glm::vec3(1.0f, 0.0f, 0.0f);
+		const size_t triCount = mesh.indices().size() / 3;
+		c.root.triIndex = triIndex;
+		c.root.bary = bary;
+		if (!sanitizeRootBinding(c.root, triCount)) {
 			HT_WARN("WARNING: addCurveOnMesh received invalid triIndex=%d (mesh tris=%zu). Root will be unpinned.\n", triIndex, triCount);
 		}
 	}
@@ -103,11 +113,33 @@ int HairGuideSet::addCurveOnMesh(const Mesh& mesh, int triIndex, const glm::vec3
 
 	// (Debug logging removed)
 
+	captureRestShape(c, mesh);
+
 	m_curves.push_back(std::move(c));
 	m_selected.push_back((unsigned char)0);
+	m_revision++;
 	return (int)m_curves.size() - 1;
 }
 
+void HairGuideSet::appendCurves(const Mesh& mesh, std::vector<HairCurve>&& curves) {
+	if (curves.empty()) return;
+	const size_t triCount = mesh.indices().size() / 3;
+	m_curves.reserve(m_curves.size() + curves.size());
+	m_selected.resize(m_selected.size() + curves.size(), (unsigned char)0);
+	int unpinned = 0;
+	for (HairCurve& c : curves) {
+		if (!sanitizeRootBinding(c.root, triCount)) unpinned++;
+		c.prevPoints = c.points;
+		if (c.restLocal.size() != c.points.size()) captureRestShape(c, mesh);
+		m_curves.push_back(std::move(c));
+	}
+	curves.clear();
+	if (unpinned > 0) {
+		HT_WARN("WARNING: appendCurves: %d curves have no valid root triangle (mesh tris=%zu). Their roots will be unpinned.\n", unpinned, triCount);
+	}
+	m_revision++;
+}
+
 static float pointRayDistance(const glm::vec3& p, const glm::vec3& ro, const glm::vec3& rd) {
 	glm::vec3 v = p - ro;
 	float t = glm::dot(v, rd);
@@ -116,6 +148,7 @@ static float pointRayDistance(const glm::vec3& p, const glm::vec3& ro, const glm
 }
 
 bool HairGuideSet::pickControlPoint(const glm::vec3& ro, const glm::vec3& rd, const glm::vec3& camPos, const glm::mat4& viewProj, int& outCurve, int& outVert, bool selectedOnly, int activeLayer, bool requireVisible) const {
+	HT_PROFILE_SCOPE(Picking);
 	(void)camPos;
 	(void)viewProj;
 	// MVP: pick closest point to ray in world space with a fixed threshold
@@ -192,6 +225,7 @@ static float raySegmentDistance(const glm::vec3& ro, const glm::vec3& rdNorm, co
 
 bool HairGuideSet::pickCurve(const glm::vec3& ro, const glm::vec3& rd, int& outCurve, int activeLayer, bool requireVisible) const {
 	if (m_curves.empty()) return false;
+	HT_PROFILE_SCOPE(Picking);
 	glm::vec3 rdNorm = rd;
 	float rdl = glm::length(rdNorm);
 	if (rdl < 1e-8f) return false;
@@ -242,6 +276,7 @@ void HairGuideSet::moveControlPoint(int curveIdx, int vertIdx, const glm::vec3&
 void HairGuideSet::removeCurve(int curveIdx) {
 	if (curveIdx < 0 || (size_t)curveIdx >= m_curves.size()) return;
 	m_curves.erase(m_curves.begin() + curveIdx);
+	m_revision++;
 	if ((size_t)curveIdx < m_selected.size()) {
 		m_selected.erase(m_selected.begin() + curveIdx);
 	}
@@ -272,6 +307,7 @@ bool HairGuideSet::isCurveSelected(size_t curveIdx) const {
 void HairGuideSet::deselectAll() {
 	for (size_t i = 0; i < m_selected.size(); i++) m_selected[i] = 0;
 	m_activeCurve = -1;
+	m_revision++;
 }
 
 void HairGuideSet::selectCurve(int curveIdx, bool additive) {
@@ -281,12 +317,14 @@ void HairGuideSet::selectCurve(int curveIdx, bool additive) {
 	}
 	m_selected[(size_t)curveIdx] = 1;
 	m_activeCurve = curveIdx;
+	m_revision++;
 }
 
 void HairGuideSet::toggleCurveSelected(int curveIdx) {
 	if (curveIdx < 0 || (size_t)curveIdx >= m_curves.size()) return;
 	unsigned char& s = m_selected[(size_t)curveIdx];
 	s = (s ? (unsigned char)0 : (unsigned char)1);
+	m_revision++;
 	if (s) {
 		m_activeCurve = curveIdx;
 	} else if (m_activeCurve == curveIdx) {
@@ -354,53 +392,66 @@ void HairGuideSet::drawDebugLines(const glm::mat4& viewProj, unsigned int linePr
 	glEnableVertexAttribArray(1);
 	glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 7 * sizeof(float), (void*)(3 * sizeof(float)));
 
-	std::vector<float> packed;
+	// Tessellate every visible curve into one vertex stream (line strips first, then control points),
+	// upload it once and issue the per-curve draws from offsets into that buffer.
+	std::vector<float>& packed = m_drawPacked;
+	std::vector<CurveDraw>& draws = m_drawCurves;
 	std::vector<glm::vec3> renderPts;
-
-	for (size_t ci = 0; ci < m_curves.size(); ci++) {
-		const HairCurve& c = m_curves[ci];
-		if (!c.visible) continue;
-		buildCurveRenderPoints(c, renderPts);
-
-		packed.clear();
-		packed.reserve(renderPts.size() * 7);
-		const bool isHover = hoverHighlightRed && ((int)ci == hoverCurve);
+	packed.clear();
+	draws.clear();
+	{
+		HT_PROFILE_SCOPE(Tessellation);
 		deselectedOpacity = glm::clamp(deselectedOpacity, 0.0f, 1.0f);
-		const bool selected = isCurveSelected(ci);
-		float a = isHover ? 1.0f : (selected ? 1.0f : deselectedOpacity);
-		glm::vec4 baseCol(c.color.r, c.color.g, c.color.b, a);
-		glm::vec4 hoverCol(1.0f, 0.15f, 0.15f, a);
-		glm::vec4 col = isHover ? hoverCol : baseCol;
-
-		for (size_t i = 0; i < renderPts.size(); i++) {
-			glm::vec3 p = renderPts[i];
+		auto push = [&packed](const glm::vec3& p, const glm::vec4& col) {
 			packed.push_back(p.x); packed.push_back(p.y); packed.push_back(p.z);
 			packed.push_back(col.r); packed.push_back(col.g); packed.push_back(col.b); packed.push_back(col.a);
+		};
+		for (size_t ci = 0; ci < m_curves.size(); ci++) {
+			const HairCurve& c = m_curves[ci];
+			if (!c.visible) continue;
+			buildCurveRenderPoints(c, renderPts);
+
+			const bool isHover = hoverHighlightRed && ((int)ci == hoverCurve);
+			const bool selected = isCurveSelected(ci);
+			float a = isHover ? 1.0f : (selected ? 1.0f : deselectedOpacity);
+			glm::vec4 baseCol(c.color.r, c.color.g, c.color.b, a);
+			glm::vec4 hoverCol(1.0f, 0.15f, 0.15f, a);
+			glm::vec4 col = isHover ? hoverCol : baseCol;
+
+			CurveDraw d{ci, (int)(packed.size() / 7), (int)renderPts.size(), 0, 0, isHover};
+			for (const glm::vec3& p : renderPts) push(p, col);
+			draws.push_back(d);
 		}
-
-		glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(float), packed.data(), GL_STREAM_DRAW);
-		if (isHover && hoverHighlightRed) {
-			glLineWidth(3.0f);
-		} else {
-			glLineWidth(oldLineWidth);
-		}
-		glDrawArrays(GL_LINE_STRIP, 0, (int)renderPts.size());
-
-		// Draw control points only for selected curves
-		if (isCurveSelected(ci)) {
-			packed.clear();
-			packed.reserve(c.points.size() * 7);
+		// Control points only for selected curves
+		for (CurveDraw& d : draws) {
+			if (!isCurveSelected(d.curve)) continue;
+			const HairCurve& c = m_curves[d.curve];
+			d.pointFirst = (int)(packed.size() / 7);
+			d.pointCount = (int)c.points.size();
 			for (size_t vi = 0; vi < c.points.size(); vi++) {
-				glm::vec3 p = c.points[vi];
 				glm::vec4 pcol = (vi == 0) ? glm::vec4(0.2f, 0.9f, 0.2f, 1.0f) : glm::vec4(0.9f, 0.9f, 0.9f, 1.0f);
-				packed.push_back(p.x); packed.push_back(p.y); packed.push_back(p.z);
-				packed.push_back(pcol.r); packed.push_back(pcol.g); packed.push_back(pcol.b); packed.push_back(pcol.a);
+				push(c.points[vi], pcol);
 			}
-			glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(float), packed.data(), GL_STREAM_DRAW);
-			glPointSize(glm::clamp(pointSizePx, 1.0f, 32.0f));
-			glDrawArrays(GL_POINTS, 0, (int)c.points.size());
 		}
 	}
+
+	{
+		HT_PROFILE_SCOPE(Upload);
+		glBufferData(GL_ARRAY_BUFFER, packed.size() * sizeof(float), packed.data(), GL_STREAM_DRAW);
+	}
+
+	bool wideLines = false;
+	for (const CurveDraw& d : draws) {
+		if (d.hover != wideLines) {
+			glLineWidth(d.hover ? 3.0f : oldLineWidth);
+			wideLines = d.hover;
+		}
+		glDrawArrays(GL_LINE_STRIP, d.lineFirst, d.lineCount);
+	}
+	glPointSize(glm::clamp(pointSizePx, 1.0f, 32.0f));
+	for (const CurveDraw& d : draws) {
+		if (d.pointCount > 0) glDrawArrays(GL_POINTS, d.pointFirst, d.pointCount);
+	}
 	glLineWidth(oldLineWidth);
 
 	glBindVertexArray(0);
@@ -409,62 +460,132 @@ void HairGuideSet::drawDebugLines(const glm::mat4& viewProj, unsigned int linePr
 	glUseProgram(0);
 }
 
+bool HairGuideSet::rootFrame(const HairCurve& c, const Mesh& mesh, glm::mat3& outFrame) {
+	const auto& pos = mesh.positions();
+	const auto& ind = mesh.indices();
+	const int ti = c.root.triIndex;
+	if (ti < 0 || (size_t)ti * 3 + 2 >= ind.size()) return false;
+	const unsigned int i0 = ind[(size_t)ti * 3 + 0];
+	const unsigned int i1 = ind[(size_t)ti * 3 + 1];
+	const unsigned int i2 = ind[(size_t)ti * 3 + 2];
+	if (i0 >= pos.size() || i1 >= pos.size() || i2 >= pos.size()) return false;
+
+	const glm::vec3 e1 = pos[i1] - pos[i0];
+	const glm::vec3 e2 = pos[i2] - pos[i0];
+	glm::vec3 z = glm::cross(e1, e2);
+	const float zl = glm::length(z);
+	const float e1l = glm::length(e1);
+	if (zl < 1e-12f || e1l < 1e-8f) return false;
+	z /= zl;
+	const glm::vec3 x = e1 / e1l;
+	outFrame = glm::mat3(x, glm::cross(z, x), z);
+	return true;
+}
+
+void HairGuideSet::transportFrame(glm::mat3& frame, const glm::vec3& segment) {
+	const float len = glm::length(segment);
+	if (len < 1e-8f) return;
+	const glm::vec3 t = segment / len;
+	const glm::vec3 z = frame[2];
+	const glm::vec3 axis = glm::cross(z, t);
+	const float s = glm::length(axis);
+	const float c = glm::dot(z, t);
+	glm::vec3 x = frame[0];
+	if (s > 1e-7f) {
+		// Rodrigues rotation of x about axis by the angle between z and t.
+		const glm::vec3 k = axis / s;
+		x = x * c + glm::cross(k, x) * s + k * glm::dot(k, x) * (1.0f - c);
+	} else if (c < 0.0f) {
+		x = -x;
+	}
+	x = x - t * glm::dot(x, t);
+	const float xl = glm::length(x);
+	if (xl < 1e-8f) return;
+	x /= xl;
+	frame = glm::mat3(x, glm::cross(t, x), t);
+}
+
+void HairGuideSet::captureRestShape(HairCurve& c, const Mesh& mesh) {
+	glm::mat3 frame;
+	if (c.points.size() < 2 || !rootFrame(c, mesh, frame)) {
+		c.restLocal.clear();
+		return;
+	}
+	c.restLocal.assign(c.points.size(), glm::vec3(0.0f));
+	for (size_t i = 1; i < c.points.size(); i++) {
+		const glm::vec3 seg = c.points[i] - c.points[i - 1];
+		const float len = glm::length(seg);
+		// Degenerate segments rest straight along the incoming direction.
+		c.restLocal[i] = (len > 1e-8f) ? glm::transpose(frame) * (seg / len) : glm::vec3(0.0f, 0.0f, 1.0f);
+		transportFrame(frame, seg);
+	}
+}
+
+void HairGuideSet::captureRestShapeSelected(const Mesh& mesh) {
+	for (size_t ci = 0; ci < m_curves.size(); ci++) {
+		if (isCurveSelected(ci)) captureRestShape(m_curves[ci], mesh);
+	}
+	m_revision++;
+}
+
 void HairGuideSet::updatePinnedRootsFromMesh(const Mesh& mesh) {
+	for (HairCurve& c : m_curves) {
+		updatePinnedRoot(c, mesh);
+	}
+}
+
+void HairGuideSet::updatePinnedRoot(HairCurve& c, const Mesh& mesh) {
 	const auto& pos = mesh.positions();
 	const auto& ind = mesh.indices();
 	if (pos.empty() || ind.empty()) return;
 	const size_t triCount = ind.size() / 3;
 
-	for (HairCurve& c : m_curves) {
-		if (c.root.triIndex < 0) continue;
-		const int ti = c.root.triIndex;
-		if ((size_t)ti >= triCount) {
-			// Defensive: prevent out-of-bounds access which can create NaNs/Inf.
-			c.root.triIndex = -1;
-			HT_WARN("WARNING: Curve root had invalid triIndex=%d (mesh tris=%zu). Unpinning root.\n", ti, triCount);
-			continue;
-		}
-		const unsigned int i0 = ind[(size_t)ti * 3 + 0];
-		const unsigned int i1 = ind[(size_t)ti * 3 + 1];
-		const unsigned int i2 = ind[(size_t)ti * 3 + 2];
-		if (i0 >= pos.size() || i1 >= pos.size() || i2 >= pos.size()) {
-			c.root.triIndex = -1;
-			HT_WARN("WARNING: Curve root triangle indices out of range. Unpinning root.\n");
-			continue;
-		}
-		glm::vec3 b = c.root.bary;
-		if (glm::any(glm::isnan(b)) || glm::any(glm::isinf(b))) {
-			b = glm::vec3(1.0f, 0.0f, 0.0f);
+	if (c.root.triIndex < 0) return;
+	const int ti = c.root.triIndex;
+	if ((size_t)ti >= triCount) {
+		// Defensive: prevent out-of-bounds access which can create NaNs/Inf.
+		c.root.triIndex = -1;
+		HT_WARN("WARNING: Curve root had invalid triIndex=%d (mesh tris=%zu). Unpinning root.\n", ti, triCount);
+		return;
+	}
+	const unsigned int i0 = ind[(size_t)ti * 3 + 0];
+	const unsigned int i1 = ind[(size_t)ti * 3 + 1];
+	const unsigned int i2 = ind[(size_t)ti * 3 + 2];
+	if (i0 >= pos.size() || i1 >= pos.size() || i2 >= pos.size()) {
+		c.root.triIndex = -1;
+		HT_WARN("WARNING: Curve root triangle indices out of range. Unpinning root.\n");
+		return;
+	}
+	glm::vec3 b = c.root.bary;
+	if (glm::any(glm::isnan(b)) || glm::any(glm::isinf(b))) {
+		b = glm::vec3(1.0f, 0.0f, 0.0f);
+	}
+	float s = b.x + b.y + b.z;
+	if (s <= 1e-8f) b = glm::vec3(1.0f, 0.0f, 0.0f);
+	else b /= s;
+	glm::vec3 p = pos[i0] * b.x + pos[i1] * b.y + pos[i2] * b.z;
+
+	if (glm::any(glm::isnan(p)) || glm::any(glm::isinf(p))) {
+		c.root.triIndex = -1;
+		HT_WARN("WARNING: Root evaluation produced NaN/Inf. Unpinning root.\n");
+		return;
+	}
+	if (!c.points.empty()) {
+		// Store velocity before update
+		glm::vec3 oldVel(0.0f);
+		if (c.points.size() > 1) {
+			oldVel = c.points[1] - c.prevPoints[1];
 		}
-		float s = b.x + b.y + b.z;
-		if (s <= 1e-8f) b = glm::vec3(1.0f, 0.0f, 0.0f);
-		else b /= s;
-		glm::vec3 p = pos[i0] * b.x + pos[i1] * b.y + pos[i2] * b.z;
-		
-		// (Debug logging removed)
 
-		if (glm::any(glm::isnan(p)) || glm::any(glm::isinf(p))) {
-			c.root.triIndex = -1;
-			HT_WARN("WARNING: Root evaluation produced NaN/Inf. Unpinning root.\n");
-			continue;
-		}
-		if (!c.points.empty()) {
-			// Store velocity before update
-			glm::vec3 oldVel(0.0f);
-			if (c.points.size() > 1) {
-				oldVel = c.points[1] - c.prevPoints[1];
-			}
-			
-			c.points[0] = p;
-			c.prevPoints[0] = p;
-			
-			// DEBUG: Check if this created velocity on vertex 1
-			if (c.points.size() > 1) {
-				glm::vec3 newVel = c.points[1] - c.prevPoints[1];
-				if (glm::length(newVel - oldVel) > 0.001f) {
-					HT_LOG("  WARNING: Root update changed vertex 1 velocity from (%.3f,%.3f,%.3f) to (%.3f,%.3f,%.3f)\n",
-					       oldVel.x, oldVel.y, oldVel.z, newVel.x, newVel.y, newVel.z);
-				}
+		c.points[0] = p;
+		c.prevPoints[0] = p;
+
+		// DEBUG: Check if this created velocity on vertex 1
+		if (c.points.size() > 1) {
+			glm::vec3 newVel = c.points[1] - c.prevPoints[1];
+			if (glm::length(newVel - oldVel) > 0.001f) {
+				HT_LOG("  WARNING: Root update changed vertex 1 velocity from (%.3f,%.3f,%.3f) to (%.3f,%.3f,%.3f)\n",
+				       oldVel.x, oldVel.y, oldVel.z, newVel.x, newVel.y, newVel.z);
 			}
 		}
 	}
@@ -534,6 +655,8 @@ static void resampleCurveInPlace(HairCurve& c, float newLength, int newSteps) {
 	c.points = std::move(newPts);
 	c.prevPoints = c.points;
 	c.segmentRestLen = newLength / (float)(newSteps - 1);
+	// Vertex count changed; the caller recaptures the rest shape.
+	c.restLocal.clear();
 }
 
 void HairGuideSet::applyLengthStepsToSelected(float newLength, int newSteps) {
@@ -541,4 +664,5 @@ void HairGuideSet::applyLengthStepsToSelected(float newLength, int newSteps) {
 		if (!isCurveSelected(ci)) continue;
 		resampleCurveInPlace(m_curves[ci], newLength, newSteps);
 	}
+	m_revision++;
 }
@@ -1,7 +1,10 @@
 #pragma once
 
+#include "Bvh.h"
+
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <vector>
 
 class Mesh;
@@ -13,14 +16,27 @@ struct GuideSettings {
 	bool enableSimulation = false;       // Master simulation toggle
 	bool enableMeshCollision = true;
 	bool enableCurveCollision = false;
+	bool continuousCollision = true;     // Sweep each point's motion against the mesh so fast moves can't tunnel through
 	bool enableGpuSolver = false;
+	bool simulationThread = true;        // Run the CPU solver off the UI thread
+	bool simulateAll = false;            // Simulate every guide on a simulated layer instead of only the selection
 	float collisionThickness = 0.0020f;
 	// Friction applied on mesh collision: 0 = slide freely, 1 = fully sticky
 	float collisionFriction = 1.0f;
 	int solverIterations = 12;
+	float solverBudgetMs = 8.0f;        // Wall time per frame the solver may use before it falls behind real time
+	bool adaptiveSolver = false;        // Lower solverIterations under load to stay within solverBudgetMs
+	bool enableSleeping = true;         // Skip settled curves until something disturbs them
+	float sleepThreshold = 1e-5f;       // Kinetic energy per unit mass (J/kg, mean over a curve's points) below which a curve settles
 	float gravity = 0.0f;               // m/s^2 (world units are meters)
 	float damping = 0.900f;             // Verlet velocity damping [0..1]
 	float stiffness = 0.10f;            // Distance constraint stiffness [0..1]
+	bool directStretchSolve = false;    // Solve each strand's stretch constraints as one tridiagonal system
+	bool rodBending = false;            // Bend toward each curve's captured rest shape (keeps curl/styling)
+	float shapeStiffness = 0.5f;        // Rod bending stiffness [0..1], independent of solverIterations
+	float shapeHold = 0.05f;            // Rod bending pull toward the rest pose relative to the root [0..1]
+	bool useXpbd = false;               // Bend constraints use XPBD compliance instead of the stiffness factor
+	float bendCompliance = 1e-5f;       // XPBD bend compliance (inverse stiffness, m/N per unit particle mass)
 	float dragLerp = 1.0f;              // Mouse drag smoothing [0..1] (higher = snappier)
 };
 
@@ -29,11 +45,27 @@ struct HairRootBinding {
 	glm::vec3 bary{0.0f};
 };
 
+// Solver sleep state (runtime only, not saved). A curve whose kinetic energy stays under
+// GuideSettings::sleepThreshold for a few frames is skipped by the solver until it is disturbed.
+struct HairCurveSleep {
+	bool sleeping = false;
+	int stillSteps = 0;                 // consecutive steps under the threshold
+	float gravity = 0.0f;               // gravity when it fell asleep; a change wakes it
+	std::vector<glm::vec3> points;      // where it fell asleep; an outside move (drag, edit, root, collision) wakes it
+};
+
 struct HairCurve {
 	HairRootBinding root;
 	std::vector<glm::vec3> points;      // control points used for physics
 	std::vector<glm::vec3> prevPoints;  // for verlet
 	float segmentRestLen = 0.0f;
+	// Rest shape for rod bending: restLocal[i] is the unit direction of segment (i-1, i) expressed in the
+	// frame carried to vertex i-1 (root frame at vertex 0, parallel-transported along the curve).
+	// restLocal[0] is unused. Empty if no rest shape has been captured.
+	std::vector<glm::vec3> restLocal;
+	HairCurveSleep sleep;
+	// Mesh collision query cache per point (runtime only, not saved); refilled whenever it doesn't fit.
+	std::vector<Bvh::NearestCache> meshCache;
 	int layerId = 0;
 	glm::vec3 color{0.90f, 0.75f, 0.22f};
 	bool visible = true;
@@ -47,8 +79,18 @@ public:
 	const HairCurve& curve(size_t idx) const { return m_curves[idx]; }
 	HairCurve& curve(size_t idx) { return m_curves[idx]; }
 
+	// Bumped on structural changes (curves added/removed/resampled, selection changed). Code that
+	// rewrites curve shapes in place through curve() should call markChanged() so the simulation
+	// thread picks the edit up.
+	uint64_t revision() const { return m_revision; }
+	void markChanged() { m_revision++; }
+
 	// Returns the new curve index, or -1 on failure.
 	int addCurveOnMesh(const Mesh& mesh, int triIndex, const glm::vec3& bary, const glm::vec3& hitPos, const glm::vec3& hitNormal, const GuideSettings& settings, int layerId, const glm::vec3& color, bool visible);
+	// Appends curves that already have their points, root binding, segmentRestLen, layer, color and visibility
+	// (scene loading, curve import), reserving storage once. Bindings are validated like addCurveOnMesh,
+	// prevPoints start at points, and curves without a matching restLocal get their shape captured as rest.
+	void appendCurves(const Mesh& mesh, std::vector<HairCurve>&& curves);
 
 	// Selection / active curve
 	bool isCurveSelected(size_t curveIdx) const;
@@ -71,11 +113,34 @@ public:
 
 	// Simulation helpers
 	void updatePinnedRootsFromMesh(const Mesh& mesh);
+	static void updatePinnedRoot(HairCurve& curve, const Mesh& mesh);
+
+	// Rod bending frames. The root frame has z = root triangle normal and x along its first edge; it is
+	// carried down the curve by parallel transport (minimal rotation onto each segment).
+	static bool rootFrame(const HairCurve& curve, const Mesh& mesh, glm::mat3& outFrame);
+	static void transportFrame(glm::mat3& frame, const glm::vec3& segment);
+	// Records the current shape as the curve's rest shape.
+	static void captureRestShape(HairCurve& curve, const Mesh& mesh);
+	void captureRestShapeSelected(const Mesh& mesh);
 
 private:
 	std::vector<HairCurve> m_curves;
 	std::vector<unsigned char> m_selected; // 1 if selected
 	int m_activeCurve = -1;
+	uint64_t m_revision = 0;
+
+	// drawDebugLines scratch, reused every frame: one interleaved position/colour stream for all visible
+	// curves and the per-curve draws into it.
+	struct CurveDraw {
+		size_t curve;
+		int lineFirst;
+		int lineCount;
+		int pointFirst;
+		int pointCount;
+		bool hover;
+	};
+	mutable std::vector<float> m_drawPacked;
+	mutable std::vector<CurveDraw> m_drawCurves;
 
 	static glm::vec3 evalCatmullRom(const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& p2, const glm::vec3& p3, float t);
 	static void buildCurveRenderPoints(const HairCurve& c, std::vector<glm::vec3>& outPoints);
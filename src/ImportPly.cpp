@@ -1,8 +1,15 @@
 #include "ImportPly.h"
 
+#include "MappedFile.h"
+#include "Parallel.h"
+#include "Trace.h"
+
 #include <algorithm>
+#include <bit>
 #include <cctype>
-#include <fstream>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <map>
 #include <sstream>
 
@@ -18,6 +25,232 @@ namespace {
 	static bool startsWith(const std::string& s, const char* pfx) {
 		return s.rfind(pfx, 0) == 0;
 	}
+
+	enum class PlyFormat { Unknown, Ascii, BinaryLittleEndian, BinaryBigEndian };
+
+	enum class PlyType { Invalid, Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64, List };
+
+	struct PlyProperty {
+		std::string name;
+		PlyType type = PlyType::Invalid;
+	};
+
+	struct PlyElement {
+		std::string name;
+		int64_t count = 0;
+		std::vector<PlyProperty> props;
+	};
+
+	static PlyType parseType(const std::string& t) {
+		if (t == "char" || t == "int8") return PlyType::Int8;
+		if (t == "uchar" || t == "uint8") return PlyType::UInt8;
+		if (t == "short" || t == "int16") return PlyType::Int16;
+		if (t == "ushort" || t == "uint16") return PlyType::UInt16;
+		if (t == "int" || t == "int32") return PlyType::Int32;
+		if (t == "uint" || t == "uint32") return PlyType::UInt32;
+		if (t == "float" || t == "float32") return PlyType::Float32;
+		if (t == "double" || t == "float64") return PlyType::Float64;
+		if (t == "list") return PlyType::List;
+		return PlyType::Invalid;
+	}
+
+	static size_t typeSize(PlyType t) {
+		switch (t) {
+		case PlyType::Int8: case PlyType::UInt8: return 1;
+		case PlyType::Int16: case PlyType::UInt16: return 2;
+		case PlyType::Int32: case PlyType::UInt32: case PlyType::Float32: return 4;
+		case PlyType::Float64: return 8;
+		default: return 0;
+		}
+	}
+
+	template <class T>
+	static inline T load(const char* src) {
+		T v;
+		std::memcpy(&v, src, sizeof(T));
+		return v;
+	}
+
+	// Reads one binary scalar; swap reverses the bytes when the file's endianness differs from the host's.
+	static inline double readScalar(const char* src, PlyType t, bool swap) {
+		char b[8];
+		if (swap) {
+			const size_t n = typeSize(t);
+			for (size_t i = 0; i < n; i++) b[i] = src[n - 1 - i];
+			src = b;
+		}
+		switch (t) {
+		case PlyType::Int8: return load<int8_t>(src);
+		case PlyType::UInt8: return load<uint8_t>(src);
+		case PlyType::Int16: return load<int16_t>(src);
+		case PlyType::UInt16: return load<uint16_t>(src);
+		case PlyType::Int32: return load<int32_t>(src);
+		case PlyType::UInt32: return load<uint32_t>(src);
+		case PlyType::Float32: return load<float>(src);
+		case PlyType::Float64: return load<double>(src);
+		default: return 0.0;
+		}
+	}
+
+	static bool isBlank(char c) {
+		return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+	}
+
+	// Token parsers with atof/atoi semantics: an optional leading '+', the longest valid prefix, 0 on garbage.
+	static double tokenToDouble(const char* p, const char* end) {
+		if (p < end && *p == '+') p++;
+		double v = 0.0;
+		if (std::from_chars(p, end, v).ec != std::errc()) return 0.0;
+		return v;
+	}
+
+	static int tokenToInt(const char* p, const char* end) {
+		if (p < end && *p == '+') p++;
+		int v = 0;
+		if (std::from_chars(p, end, v).ec != std::errc()) return 0;
+		return v;
+	}
+
+	// Returns the line starting at p (advancing p past it), or nullptr at end.
+	static const char* nextLine(const char*& p, const char* end, const char*& lineEnd) {
+		if (p >= end) return nullptr;
+		const char* lineStart = p;
+		const char* nl = (const char*)std::memchr(p, '\n', (size_t)(end - p));
+		lineEnd = nl ? nl : end;
+		p = nl ? nl + 1 : end;
+		return lineStart;
+	}
+
+	struct PlyVertex {
+		glm::vec3 p{0.0f};
+		int anchor = 0;
+		int curveId = 0;
+		int layerId = 0;
+		bool valid = false; // ASCII line with fewer than three columns: counts as a vertex but is dropped
+	};
+
+	// Which of x/y/z (0-2) or anchor/curve_id/layer_id (3-5) each column holds; other columns are -1
+	// and never converted.
+	struct AsciiColumns {
+		std::vector<int> roleOf;
+		int lastProp = 0;
+	};
+
+	// Parses the vertex lines in [p, end) into out, at most maxVertices of them. Blank lines don't count.
+	static void parseAsciiVertices(const char* p, const char* end, const AsciiColumns& cols, int64_t maxVertices, std::vector<PlyVertex>& out) {
+		HT_TRACE_SCOPE("ImportPly::parseAsciiVertices");
+		out.clear();
+		out.reserve(std::min<size_t>((size_t)maxVertices, (size_t)(end - p) / 16 + 1));
+		const char* lineEnd = nullptr;
+		while ((int64_t)out.size() < maxVertices) {
+			const char* q = nextLine(p, end, lineEnd);
+			if (!q) break;
+
+			PlyVertex v;
+			int ints[3] = {0, 0, 0};
+			int tokens = 0;
+			while (tokens <= cols.lastProp) {
+				while (q < lineEnd && isBlank(*q)) q++;
+				if (q == lineEnd) break;
+				const char* tokEnd = q;
+				while (tokEnd < lineEnd && !isBlank(*tokEnd)) tokEnd++;
+				const int role = cols.roleOf[(size_t)tokens];
+				if (role >= 0 && role < 3) v.p[role] = (float)tokenToDouble(q, tokEnd);
+				else if (role >= 3) ints[role - 3] = tokenToInt(q, tokEnd);
+				q = tokEnd;
+				tokens++;
+			}
+			if (tokens == 0) continue;
+			v.valid = (tokens >= 3);
+			v.anchor = ints[0];
+			v.curveId = ints[1];
+			v.layerId = ints[2];
+			out.push_back(v);
+		}
+	}
+
+	// Binary vertex records viewed in place in the mapped file: record v starts at base + v * stride.
+	// Roles are x/y/z (0-2) and anchor/curve_id/layer_id (3-5); absent roles have type Invalid.
+	struct StridedVertices {
+		const char* base = nullptr;
+		size_t stride = 0;
+		int64_t count = 0;
+		bool swap = false;
+		size_t offset[6] = {};
+		PlyType type[6] = {PlyType::Invalid, PlyType::Invalid, PlyType::Invalid, PlyType::Invalid, PlyType::Invalid, PlyType::Invalid};
+
+		int intValue(const char* rec, int role) const {
+			return (type[role] != PlyType::Invalid) ? (int)readScalar(rec + offset[role], type[role], swap) : 0;
+		}
+
+		PlyVertex vertex(int64_t v) const {
+			const char* rec = base + (size_t)v * stride;
+			PlyVertex out;
+			for (int r = 0; r < 3; r++) out.p[r] = (float)readScalar(rec + offset[r], type[r], swap);
+			out.anchor = intValue(rec, 3);
+			out.curveId = intValue(rec, 4);
+			out.layerId = intValue(rec, 5);
+			out.valid = true;
+			return out;
+		}
+
+		// Just curve_id and layer_id, for counting.
+		PlyVertex ids(int64_t v) const {
+			const char* rec = base + (size_t)v * stride;
+			PlyVertex out;
+			out.curveId = intValue(rec, 4);
+			out.layerId = intValue(rec, 5);
+			out.valid = true;
+			return out;
+		}
+	};
+
+	// Per curve_id counter, later reused for the curve's slot in the store. Exported ids run 0..n-1,
+	// so they index a dense table; anything else (negative or larger than the vertex count) goes to a
+	// map. Runs of the same id, which is how curves are written, skip the lookup entirely.
+	class CurveIdTable {
+	public:
+		explicit CurveIdTable(int64_t maxDenseId) : m_maxDenseId(maxDenseId) {}
+
+		int64_t& entry(int id) {
+			if (m_last && id == m_lastId) return *m_last;
+			if (id >= 0 && (int64_t)id < m_maxDenseId) {
+				if ((size_t)id >= m_dense.size()) m_dense.resize((size_t)id + 1, 0);
+				m_last = &m_dense[(size_t)id];
+			} else {
+				m_last = &m_sparse[id];
+			}
+			m_lastId = id;
+			return *m_last;
+		}
+
+		// Turns the counts into slots: ids with at least minPoints vertices get consecutive slots in
+		// ascending id order and their ranges are appended to offsets; the rest get -1. Returns the
+		// number of slots.
+		size_t assignSlots(int64_t minPoints, std::vector<size_t>& offsets) {
+			size_t slots = 0;
+			auto assign = [&](int64_t& e) {
+				if (e >= minPoints) {
+					offsets.push_back(offsets.back() + (size_t)e);
+					e = (int64_t)slots++;
+				} else {
+					e = -1;
+				}
+			};
+			auto it = m_sparse.begin();
+			for (; it != m_sparse.end() && it->first < 0; ++it) assign(it->second);
+			for (int64_t& e : m_dense) assign(e);
+			for (; it != m_sparse.end(); ++it) assign(it->second);
+			return slots;
+		}
+
+	private:
+		int64_t m_maxDenseId = 0;
+		std::vector<int64_t> m_dense;
+		std::map<int, int64_t> m_sparse;
+		int64_t* m_last = nullptr;
+		int m_lastId = 0;
+	};
 }
 
 static bool parseLayerComment(const std::string& line, ImportPly::ImportedLayer& outLayer) {
@@ -49,28 +282,28 @@ static bool parseLayerComment(const std::string& line, ImportPly::ImportedLayer&
 	return true;
 }
 
-bool ImportPly::loadCurves(const std::string& path, std::vector<ImportedCurve>& outCurves, std::vector<ImportedLayer>* outLayers, bool* outHasLayerInfo, std::string* outError) {
+bool ImportPly::loadCurves(const std::string& path, ImportedCurves& outCurves, std::vector<ImportedLayer>* outLayers, bool* outHasLayerInfo, std::string* outError, bool parallel) {
+	HT_TRACE_SCOPE("ImportPly::loadCurves");
 	outCurves.clear();
 	if (outLayers) outLayers->clear();
 	if (outHasLayerInfo) *outHasLayerInfo = false;
 	if (outError) outError->clear();
 
-	std::ifstream f(path, std::ios::binary);
-	if (!f.is_open()) {
-		if (outError) *outError = "Failed to open file";
-		return false;
-	}
+	// The file is mapped rather than streamed: the header is read line by line from the mapping and
+	// the vertex block is parsed in place.
+	MappedFile file;
+	if (!file.open(path, outError)) return false;
+	const char* p = file.data();
+	const char* const end = p + file.size();
 
-	std::string line;
 	bool sawPly = false;
-	bool ascii = false;
-	bool inVertex = false;
-	int vertexCount = 0;
-	std::vector<std::string> props;
+	PlyFormat format = PlyFormat::Unknown;
+	std::vector<PlyElement> elements;
 
 	std::map<int, ImportedLayer> layersById;
-	while (std::getline(f, line)) {
-		line = trim(line);
+	const char* lineEnd = nullptr;
+	while (const char* lineStart = nextLine(p, end, lineEnd)) {
+		const std::string line = trim(std::string(lineStart, lineEnd));
 		if (line.empty()) continue;
 
 		if (!sawPly) {
@@ -83,8 +316,10 @@ bool ImportPly::loadCurves(const std::string& path, std::vector<ImportedCurve>&
 		}
 
 		if (startsWith(line, "format ")) {
-			// format ascii 1.0
-			ascii = (line.find("ascii") != std::string::npos);
+			// format ascii 1.0 | format binary_little_endian 1.0 | format binary_big_endian 1.0
+			if (line.find("binary_little_endian") != std::string::npos) format = PlyFormat::BinaryLittleEndian;
+			else if (line.find("binary_big_endian") != std::string::npos) format = PlyFormat::BinaryBigEndian;
+			else if (line.find("ascii") != std::string::npos) format = PlyFormat::Ascii;
 			continue;
 		}
 
@@ -96,45 +331,58 @@ bool ImportPly::loadCurves(const std::string& path, std::vector<ImportedCurve>&
 			continue;
 		}
 
-		if (startsWith(line, "element vertex ")) {
-			std::istringstream iss(line);
-			std::string a, b;
-			iss >> a >> b >> vertexCount;
-			inVertex = true;
-			props.clear();
-			continue;
-		}
-
 		if (startsWith(line, "element ")) {
-			inVertex = false;
+			std::istringstream iss(line);
+			std::string kw;
+			PlyElement e;
+			iss >> kw >> e.name >> e.count;
+			elements.push_back(e);
 			continue;
 		}
 
-		if (startsWith(line, "property ") && inVertex) {
-			// property float x
+		if (startsWith(line, "property ") && !elements.empty()) {
+			// property float x | property list uchar int vertex_indices
 			std::istringstream iss(line);
 			std::string kw, type, name;
 			iss >> kw >> type >> name;
-			if (!name.empty()) props.push_back(name);
+			PlyProperty prop;
+			prop.type = parseType(type);
+			if (prop.type == PlyType::List) {
+				std::string itemType;
+				iss >> itemType >> name;
+			}
+			prop.name = name;
+			if (!name.empty()) elements.back().props.push_back(prop);
 			continue;
 		}
 
 		if (line == "end_header") break;
 	}
 
-	if (!ascii) {
-		if (outError) *outError = "Only ASCII PLY is supported";
+	if (format == PlyFormat::Unknown) {
+		if (outError) *outError = "Unsupported PLY format";
 		return false;
 	}
-	if (vertexCount <= 0) {
+
+	size_t vertexElement = elements.size();
+	for (size_t e = 0; e < elements.size(); e++) {
+		if (elements[e].name == "vertex") {
+			vertexElement = e;
+			break;
+		}
+	}
+	if (vertexElement == elements.size() || elements[vertexElement].count <= 0) {
 		if (outError) *outError = "PLY has no vertices";
 		return false;
 	}
+	const PlyElement& vertex = elements[vertexElement];
+	const int64_t vertexCount = vertex.count;
 
 	auto findProp = [&](const char* name) -> int {
-		auto it = std::find(props.begin(), props.end(), std::string(name));
-		if (it == props.end()) return -1;
-		return (int)std::distance(props.begin(), it);
+		for (size_t i = 0; i < vertex.props.size(); i++) {
+			if (vertex.props[i].name == name) return (int)i;
+		}
+		return -1;
 	};
 
 	const int ix = findProp("x");
@@ -147,71 +395,156 @@ bool ImportPly::loadCurves(const std::string& path, std::vector<ImportedCurve>&
 	const int iAnchor = findProp("anchor");
 	const int iCurveId = findProp("curve_id");
 	const int iLayerId = findProp("layer_id");
-	bool sawNonZeroLayerId = false;
-
-	// Grouping: prefer curve_id if present. Otherwise, split by anchor==1 if present; else treat as one curve.
-	std::map<int, ImportedCurve> curvesById;
-	ImportedCurve current;
-	bool useAnchorSplitting = (iCurveId < 0 && iAnchor >= 0);
-
-	for (int v = 0; v < vertexCount; v++) {
-		if (!std::getline(f, line)) break;
-		line = trim(line);
-		if (line.empty()) {
-			v--;
-			continue;
+	const int roleProps[6] = {ix, iy, iz, iAnchor, iCurveId, iLayerId};
+
+	// ASCII lines are tokenized into per-chunk buffers; binary records are decoded straight from the
+	// mapping when the curves are built.
+	std::vector<std::vector<PlyVertex>> chunks;
+	StridedVertices records;
+
+	if (format == PlyFormat::Ascii) {
+		// Elements before the vertex block take one line per item.
+		int64_t skipLines = 0;
+		for (size_t e = 0; e < vertexElement; e++) skipLines += elements[e].count;
+		for (int64_t i = 0; i < skipLines && nextLine(p, end, lineEnd); i++) {}
+
+		AsciiColumns cols;
+		for (int r : roleProps) cols.lastProp = std::max(cols.lastProp, r);
+		cols.roleOf.assign((size_t)cols.lastProp + 1, -1);
+		for (int r = 0; r < 6; r++) {
+			if (roleProps[r] >= 0) cols.roleOf[(size_t)roleProps[r]] = r;
 		}
 
-		std::istringstream iss(line);
-		std::vector<std::string> toks;
-		std::string tok;
-		while (iss >> tok) toks.push_back(tok);
-		if ((int)toks.size() < 3) continue;
+		// Large bodies are split at line boundaries and parsed concurrently into per-chunk buffers.
+		// Reading the chunks in order keeps the file's vertex order, and so the curve order.
+		const size_t kMinChunkBytes = 256 * 1024;
+		const size_t maxChunks = (parallel && Parallel::threadCount() > 1) ? (size_t)Parallel::threadCount() * 4 : 1;
+		const size_t chunkCount = std::clamp((size_t)(end - p) / kMinChunkBytes, (size_t)1, maxChunks);
+		std::vector<const char*> bounds(chunkCount + 1, end);
+		bounds[0] = p;
+		for (size_t k = 1; k < chunkCount; k++) {
+			const char* split = std::max(bounds[k - 1], p + (size_t)(end - p) * k / chunkCount);
+			const char* nl = (const char*)std::memchr(split, '\n', (size_t)(end - split));
+			bounds[k] = nl ? nl + 1 : end;
+		}
 
-		auto getFloat = [&](int idx) -> float {
-			if (idx < 0 || idx >= (int)toks.size()) return 0.0f;
-			return (float)std::atof(toks[(size_t)idx].c_str());
-		};
-		auto getInt = [&](int idx) -> int {
-			if (idx < 0 || idx >= (int)toks.size()) return 0;
-			return std::atoi(toks[(size_t)idx].c_str());
+		chunks.resize(chunkCount);
+		Parallel::forRange(chunkCount, 1, [&](size_t begin, size_t endChunk) {
+			for (size_t k = begin; k < endChunk; k++) parseAsciiVertices(bounds[k], bounds[k + 1], cols, vertexCount, chunks[k]);
+		});
+		// Whatever follows the vertex block (faces) was parsed too; drop it.
+		int64_t remaining = vertexCount;
+		for (std::vector<PlyVertex>& chunk : chunks) {
+			if ((int64_t)chunk.size() > remaining) chunk.resize((size_t)remaining);
+			remaining -= (int64_t)chunk.size();
+		}
+	} else {
+		// Binary: fixed-size records, so list properties (faces) can only come after the vertices.
+		auto recordSize = [](const PlyElement& e) -> size_t {
+			size_t size = 0;
+			for (const PlyProperty& prop : e.props) {
+				const size_t n = typeSize(prop.type);
+				if (n == 0) return 0;
+				size += n;
+			}
+			return size;
 		};
+		size_t skipBytes = 0;
+		for (size_t e = 0; e < vertexElement; e++) {
+			const size_t size = recordSize(elements[e]);
+			if (size == 0) {
+				if (outError) *outError = "Unsupported PLY: variable-size element before the vertices";
+				return false;
+			}
+			skipBytes += size * (size_t)elements[e].count;
+		}
+		const size_t stride = recordSize(vertex);
+		if (stride == 0) {
+			if (outError) *outError = "Unsupported PLY vertex property type";
+			return false;
+		}
+		const size_t offset = std::min(skipBytes, (size_t)(end - p));
+		records.base = p + offset;
+		records.stride = stride;
+		// A truncated file keeps the complete records it has.
+		records.count = std::min(vertexCount, (int64_t)((size_t)(end - records.base) / stride));
+		const bool fileLittle = (format == PlyFormat::BinaryLittleEndian);
+		records.swap = fileLittle != (std::endian::native == std::endian::little);
+		for (int r = 0; r < 6; r++) {
+			const int prop = roleProps[r];
+			if (prop < 0) continue;
+			for (int i = 0; i < prop; i++) records.offset[r] += typeSize(vertex.props[(size_t)i].type);
+			records.type[r] = vertex.props[(size_t)prop].type;
+		}
+	}
 
-		glm::vec3 p(getFloat(ix), getFloat(iy), getFloat(iz));
-		int anchor = (iAnchor >= 0) ? getInt(iAnchor) : 0;
-		int cid = (iCurveId >= 0) ? getInt(iCurveId) : 0;
-		int lid = (iLayerId >= 0) ? getInt(iLayerId) : 0;
-		if (lid != 0) sawNonZeroLayerId = true;
-
-		if (iCurveId >= 0) {
-			ImportedCurve& c = curvesById[cid];
-			int localIndex = (int)c.points.size();
-			c.points.push_back(p);
-			if (c.layerId == 0 && lid != 0) c.layerId = lid;
-			if (anchor == 1 && c.anchorIndex < 0) c.anchorIndex = localIndex;
-		} else if (useAnchorSplitting) {
-			if (anchor == 1 && !current.points.empty()) {
-				outCurves.push_back(current);
-				current = ImportedCurve();
+	// With idsOnly, binary records decode only curve_id and layer_id.
+	auto forEachVertex = [&](bool idsOnly, auto&& fn) {
+		if (format == PlyFormat::Ascii) {
+			for (const std::vector<PlyVertex>& chunk : chunks) {
+				for (const PlyVertex& v : chunk) {
+					if (v.valid) fn(v);
+				}
 			}
-			int localIndex = (int)current.points.size();
-			current.points.push_back(p);
-			if (current.layerId == 0 && lid != 0) current.layerId = lid;
-			if (anchor == 1 && current.anchorIndex < 0) current.anchorIndex = localIndex;
+		} else if (idsOnly) {
+			for (int64_t v = 0; v < records.count; v++) fn(records.ids(v));
 		} else {
-			int localIndex = (int)current.points.size();
-			current.points.push_back(p);
-			if (current.layerId == 0 && lid != 0) current.layerId = lid;
-			if (anchor == 1 && current.anchorIndex < 0) current.anchorIndex = localIndex;
+			for (int64_t v = 0; v < records.count; v++) fn(records.vertex(v));
 		}
-	}
+	};
 
+	// Grouping: prefer curve_id if present. Otherwise, split by anchor==1 if present; else treat as one curve.
+	bool sawNonZeroLayerId = false;
+	std::vector<glm::vec3>& points = outCurves.points;
+	std::vector<size_t>& offsets = outCurves.offsets;
 	if (iCurveId >= 0) {
-		for (auto& kv : curvesById) {
-			if (kv.second.points.size() >= 2) outCurves.push_back(kv.second);
-		}
+		// Two passes: count the points of every curve, then write each point straight into its
+		// curve's range of the store.
+		CurveIdTable ids(vertexCount);
+		forEachVertex(true, [&](const PlyVertex& v) {
+			ids.entry(v.curveId)++;
+			if (v.layerId != 0) sawNonZeroLayerId = true;
+		});
+		const size_t curveCount = ids.assignSlots(2, offsets);
+		points.resize(offsets.back());
+		outCurves.anchorIndex.assign(curveCount, -1);
+		outCurves.layerId.assign(curveCount, 0);
+		std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+		forEachVertex(false, [&](const PlyVertex& v) {
+			const int64_t slot = ids.entry(v.curveId);
+			if (slot < 0) return;
+			const size_t s = (size_t)slot;
+			if (v.anchor == 1 && outCurves.anchorIndex[s] < 0) outCurves.anchorIndex[s] = (int)(cursor[s] - offsets[s]);
+			if (outCurves.layerId[s] == 0 && v.layerId != 0) outCurves.layerId[s] = v.layerId;
+			points[cursor[s]++] = v.p;
+		});
 	} else {
-		if (current.points.size() >= 2) outCurves.push_back(current);
+		// Vertices are already in curve order; curves close on each anchor (when splitting) and at the end.
+		const bool useAnchorSplitting = (iAnchor >= 0);
+		size_t curveStart = 0;
+		int anchorIndex = -1;
+		int layerId = 0;
+		auto closeCurve = [&](size_t minPoints) {
+			if (points.size() - curveStart >= minPoints) {
+				offsets.push_back(points.size());
+				outCurves.anchorIndex.push_back(anchorIndex);
+				outCurves.layerId.push_back(layerId);
+			} else {
+				points.resize(curveStart);
+			}
+			curveStart = points.size();
+			anchorIndex = -1;
+			layerId = 0;
+		};
+		points.reserve((size_t)vertexCount);
+		forEachVertex(false, [&](const PlyVertex& v) {
+			if (v.layerId != 0) sawNonZeroLayerId = true;
+			if (useAnchorSplitting && v.anchor == 1 && points.size() > curveStart) closeCurve(1);
+			if (v.anchor == 1 && anchorIndex < 0) anchorIndex = (int)(points.size() - curveStart);
+			if (layerId == 0 && v.layerId != 0) layerId = v.layerId;
+			points.push_back(v.p);
+		});
+		closeCurve(2);
 	}
 
 	if (outHasLayerInfo) {
@@ -224,7 +557,7 @@ bool ImportPly::loadCurves(const std::string& path, std::vector<ImportedCurve>&
 		}
 	}
 
-	if (outCurves.empty()) {
+	if (outCurves.curveCount() == 0) {
 		if (outError) *outError = "No curves found";
 		return false;
 	}
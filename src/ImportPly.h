@@ -2,6 +2,7 @@
 
 #include <glm/glm.hpp>
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
@@ -13,15 +14,29 @@ namespace ImportPly {
 		bool visible = true;
 	};
 
-	struct ImportedCurve {
+	// Imported curves in one contiguous particle array: curve i owns points[offsets[i], offsets[i + 1]).
+	struct ImportedCurves {
 		std::vector<glm::vec3> points;
-		int anchorIndex = -1; // index of the vertex flagged as anchor/root, or -1
-		int layerId = 0;
+		std::vector<size_t> offsets{0};
+		std::vector<int> anchorIndex; // per curve: index of the vertex flagged as anchor/root, or -1
+		std::vector<int> layerId;     // per curve
+
+		size_t curveCount() const { return anchorIndex.size(); }
+		size_t pointCount(size_t ci) const { return offsets[ci + 1] - offsets[ci]; }
+		const glm::vec3* curvePoints(size_t ci) const { return points.data() + offsets[ci]; }
+		void clear() {
+			points.clear();
+			offsets.assign(1, 0);
+			anchorIndex.clear();
+			layerId.clear();
+		}
 	};
 
-	// Loads curves from an ASCII PLY file. Supports the HairTool export format:
-	//   x y z anchor curve_id
+	// Loads curves from an ASCII or binary (little/big endian) PLY file, memory-mapped and parsed in place.
+	// Supports the HairTool export format:
+	//   x y z anchor layer_id curve_id
 	// If curve_id is missing, all vertices are treated as one curve.
 	// If anchor is present and curve_id is missing, each anchor==1 starts a new curve.
-	bool loadCurves(const std::string& path, std::vector<ImportedCurve>& outCurves, std::vector<ImportedLayer>* outLayers = nullptr, bool* outHasLayerInfo = nullptr, std::string* outError = nullptr);
+	// With parallel set, large ASCII files are tokenized on the worker pool (same result as serial).
+	bool loadCurves(const std::string& path, ImportedCurves& outCurves, std::vector<ImportedLayer>* outLayers = nullptr, bool* outHasLayerInfo = nullptr, std::string* outError = nullptr, bool parallel = true);
 }
@@ -0,0 +1,98 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+#include <filesystem>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path, std::string* outError) {
+	close();
+	// Same narrow-path interpretation as std::ifstream.
+	HANDLE file = CreateFileW(std::filesystem::path(path).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		if (outError) *outError = "Failed to open file";
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		CloseHandle(file);
+		if (outError) *outError = "Failed to open file";
+		return false;
+	}
+	m_file = file;
+	if (size.QuadPart == 0) return true; // empty files can't be mapped
+
+	m_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	const void* view = m_mapping ? MapViewOfFile((HANDLE)m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!view) {
+		close();
+		if (outError) *outError = "Failed to map file";
+		return false;
+	}
+	m_data = (const char*)view;
+	m_size = (size_t)size.QuadPart;
+	return true;
+}
+
+void MappedFile::close() {
+	if (m_data) UnmapViewOfFile(m_data);
+	if (m_mapping) CloseHandle((HANDLE)m_mapping);
+	if (m_file) CloseHandle((HANDLE)m_file);
+	m_data = nullptr;
+	m_size = 0;
+	m_mapping = nullptr;
+	m_file = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, std::string* outError) {
+	close();
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd < 0) {
+		if (outError) *outError = "Failed to open file";
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		::close(fd);
+		if (outError) *outError = "Failed to open file";
+		return false;
+	}
+	if (st.st_size == 0) {
+		::close(fd);
+		return true;
+	}
+
+	void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // the mapping keeps the file referenced
+	if (view == MAP_FAILED) {
+		if (outError) *outError = "Failed to map file";
+		return false;
+	}
+	madvise(view, (size_t)st.st_size, MADV_SEQUENTIAL);
+	m_data = (const char*)view;
+	m_size = (size_t)st.st_size;
+	return true;
+}
+
+void MappedFile::close() {
+	if (m_data) munmap((void*)m_data, m_size);
+	m_data = nullptr;
+	m_size = 0;
+}
+
+#endif
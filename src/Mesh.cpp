@@ -1,11 +1,14 @@
 #include "Mesh.h"
 
+#include "Trace.h"
+
 #include <glad/glad.h>
 
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+#include <algorithm>
 #include <cstdio>
 
 struct Vertex {
@@ -78,11 +81,77 @@ bool Mesh::loadFromObj(const std::string& path) {
 		baseVertex += m->mNumVertices;
 	}
 
-	upload();
+	buildTopology();
+	m_gpuDirty = true;
 	return !m_positions.empty() && !m_indices.empty();
 }
 
-void Mesh::upload() {
+void Mesh::buildTopology() {
+	HT_TRACE_SCOPE("Mesh::buildTopology");
+	const uint64_t t0 = Trace::nowNs();
+
+	// Weld by exact position: seams split vertices that are the same point on the surface.
+	m_weld.resize(m_positions.size());
+	std::vector<uint32_t> order(m_positions.size());
+	for (size_t v = 0; v < order.size(); v++) order[v] = (uint32_t)v;
+	auto less = [&](uint32_t a, uint32_t b) {
+		const glm::vec3& pa = m_positions[a];
+		const glm::vec3& pb = m_positions[b];
+		if (pa.x != pb.x) return pa.x < pb.x;
+		if (pa.y != pb.y) return pa.y < pb.y;
+		if (pa.z != pb.z) return pa.z < pb.z;
+		return a < b;
+	};
+	std::sort(order.begin(), order.end(), less);
+	uint32_t welded = 0;
+	for (size_t k = 0; k < order.size(); k++) {
+		if (k > 0 && m_positions[order[k]] != m_positions[order[k - 1]]) welded++;
+		m_weld[order[k]] = welded;
+	}
+	const size_t weldedCount = order.empty() ? 0 : (size_t)welded + 1;
+
+	// Counting sort of the triangle corners by welded vertex.
+	m_vertexTriOffsets.assign(weldedCount + 1, 0);
+	for (unsigned int v : m_indices) m_vertexTriOffsets[(size_t)m_weld[v] + 1]++;
+	for (size_t w = 0; w < weldedCount; w++) m_vertexTriOffsets[w + 1] += m_vertexTriOffsets[w];
+	m_vertexTris.resize(m_indices.size());
+	std::vector<uint32_t> fill(m_vertexTriOffsets.begin(), m_vertexTriOffsets.end() - 1);
+	for (size_t i = 0; i < m_indices.size(); i++) m_vertexTris[fill[m_weld[m_indices[i]]]++] = (uint32_t)(i / 3);
+
+	// Edge neighbours: the other triangle around corner a that also has corner b.
+	const size_t triCount = m_indices.size() / 3;
+	m_triNeighbors.assign(triCount * 3, -1);
+	size_t openEdges = 0;
+	size_t nonManifold = 0;
+	for (size_t t = 0; t < triCount; t++) {
+		for (int k = 0; k < 3; k++) {
+			const uint32_t a = m_weld[m_indices[t * 3 + (size_t)k]];
+			const uint32_t b = m_weld[m_indices[t * 3 + (size_t)((k + 1) % 3)]];
+			if (a == b) continue; // degenerate edge
+			int found = -1;
+			int matches = 0;
+			for (uint32_t r = m_vertexTriOffsets[a]; r < m_vertexTriOffsets[(size_t)a + 1]; r++) {
+				const uint32_t u = m_vertexTris[r];
+				if (u == t) continue;
+				if (m_weld[m_indices[(size_t)u * 3 + 0]] == b || m_weld[m_indices[(size_t)u * 3 + 1]] == b || m_weld[m_indices[(size_t)u * 3 + 2]] == b) {
+					found = (int)u;
+					matches++;
+				}
+			}
+			if (matches == 1) m_triNeighbors[t * 3 + (size_t)k] = found;
+			else if (matches == 0) openEdges++;
+			else nonManifold++;
+		}
+	}
+
+	m_topologyStats.buildMs = (double)(Trace::nowNs() - t0) * 1e-6;
+	m_topologyStats.bytes = (m_weld.size() + m_vertexTriOffsets.size() + m_vertexTris.size()) * sizeof(uint32_t) + m_triNeighbors.size() * sizeof(int32_t);
+	m_topologyStats.weldedVertices = weldedCount;
+	m_topologyStats.openEdges = openEdges;
+	m_topologyStats.nonManifoldEdges = nonManifold;
+}
+
+void Mesh::upload() const {
 	if (!m_vao) {
 		glGenVertexArrays(1, &m_vao);
 		glGenBuffers(1, &m_vbo);
@@ -112,9 +181,11 @@ void Mesh::upload() {
 
 	glBindVertexArray(0);
 	m_indexCount = (int)m_indices.size();
+	m_gpuDirty = false;
 }
 
 void Mesh::draw() const {
+	if (m_gpuDirty) upload();
 	if (!m_vao) return;
 	glBindVertexArray(m_vao);
 	glDrawElements(GL_TRIANGLES, m_indexCount, GL_UNSIGNED_INT, nullptr);
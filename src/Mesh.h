@@ -2,6 +2,7 @@
 
 #include <glm/glm.hpp>
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -15,6 +16,26 @@ public:
 	const std::vector<glm::vec2>& uvs() const { return m_uvs; }
 	const std::vector<unsigned int>& indices() const { return m_indices; }
 
+	// Topology for local walks over the surface (collision caching, root placement). Built by loadFromObj.
+	// It ignores UV/normal seams: vertices at the same position share one welded index.
+	const std::vector<uint32_t>& weldedVertices() const { return m_weld; }
+	// Triangles around welded vertex w: vertexTriangles()[vertexTriangleOffsets()[w] .. vertexTriangleOffsets()[w + 1]).
+	const std::vector<uint32_t>& vertexTriangleOffsets() const { return m_vertexTriOffsets; }
+	const std::vector<uint32_t>& vertexTriangles() const { return m_vertexTris; }
+	// triangleNeighbors()[t * 3 + k]: triangle across the edge from corner k to corner k + 1 of triangle t,
+	// -1 on open edges and edges shared by more than two triangles.
+	const std::vector<int32_t>& triangleNeighbors() const { return m_triNeighbors; }
+
+	struct TopologyStats {
+		double buildMs = 0.0;
+		size_t bytes = 0;
+		size_t weldedVertices = 0;
+		size_t openEdges = 0;
+		size_t nonManifoldEdges = 0;     // counted once per triangle side
+	};
+	const TopologyStats& topologyStats() const { return m_topologyStats; }
+	void buildTopology();
+
 	glm::vec3 boundsMin() const { return m_boundsMin; }
 	glm::vec3 boundsMax() const { return m_boundsMax; }
 
@@ -23,14 +44,21 @@ private:
 	std::vector<glm::vec3> m_normals;
 	std::vector<glm::vec2> m_uvs;
 	std::vector<unsigned int> m_indices;
+	std::vector<uint32_t> m_weld;
+	std::vector<uint32_t> m_vertexTriOffsets;
+	std::vector<uint32_t> m_vertexTris;
+	std::vector<int32_t> m_triNeighbors;
+	TopologyStats m_topologyStats;
 
 	glm::vec3 m_boundsMin{0};
 	glm::vec3 m_boundsMax{0};
 
-	unsigned int m_vao = 0;
-	unsigned int m_vbo = 0;
-	unsigned int m_ebo = 0;
-	int m_indexCount = 0;
+	// GPU buffers are created lazily on first draw so headless tools can load meshes without a GL context.
+	mutable unsigned int m_vao = 0;
+	mutable unsigned int m_vbo = 0;
+	mutable unsigned int m_ebo = 0;
+	mutable int m_indexCount = 0;
+	mutable bool m_gpuDirty = false;
 
-	void upload();
+	void upload() const;
 };
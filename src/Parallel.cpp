@@ -0,0 +1,125 @@
+#include "Parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+	// Worker threads are started on first use and live until exit.
+	class Pool {
+	public:
+		Pool() {
+			const unsigned hw = std::thread::hardware_concurrency();
+			const int workers = std::clamp((int)hw - 1, 0, 15);
+			for (int i = 0; i < workers; i++) m_workers.emplace_back([this]() { workerMain(); });
+		}
+
+		~Pool() {
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_stop = true;
+			}
+			m_wake.notify_all();
+			for (std::thread& t : m_workers) t.join();
+		}
+
+		int threadCount() const { return (int)m_workers.size() + 1; }
+
+		// Returns false if the pool is busy with another caller's loop.
+		bool tryRun(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+			std::unique_lock<std::mutex> busy(m_runMutex, std::try_to_lock);
+			if (!busy.owns_lock()) return false;
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_fn = &fn;
+				m_count = count;
+				m_grain = grain;
+				m_next.store(0, std::memory_order_relaxed);
+				m_pendingWorkers = (int)m_workers.size();
+				m_job++;
+			}
+			m_wake.notify_all();
+
+			t_inPool = true;
+			runChunks();
+			t_inPool = false;
+
+			// Workers touch the job state until they check out, so wait for all of them.
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_done.wait(lock, [&]() { return m_pendingWorkers == 0; });
+			m_fn = nullptr;
+			return true;
+		}
+
+		static thread_local bool t_inPool;
+
+	private:
+		void runChunks() {
+			for (;;) {
+				const size_t begin = m_next.fetch_add(m_grain, std::memory_order_relaxed);
+				if (begin >= m_count) break;
+				(*m_fn)(begin, std::min(m_count, begin + m_grain));
+			}
+		}
+
+		void workerMain() {
+			t_inPool = true;
+			uint64_t seenJob = 0;
+			for (;;) {
+				{
+					std::unique_lock<std::mutex> lock(m_mutex);
+					m_wake.wait(lock, [&]() { return m_stop || m_job != seenJob; });
+					if (m_stop) return;
+					seenJob = m_job;
+				}
+				runChunks();
+				{
+					std::lock_guard<std::mutex> lock(m_mutex);
+					m_pendingWorkers--;
+				}
+				m_done.notify_one();
+			}
+		}
+
+		std::vector<std::thread> m_workers;
+		std::mutex m_runMutex;           // one loop at a time
+
+		std::mutex m_mutex;
+		std::condition_variable m_wake;
+		std::condition_variable m_done;
+		bool m_stop = false;
+		uint64_t m_job = 0;
+		int m_pendingWorkers = 0;
+
+		// Current loop; written under m_mutex before m_job changes.
+		const std::function<void(size_t, size_t)>* m_fn = nullptr;
+		size_t m_count = 0;
+		size_t m_grain = 1;
+		std::atomic<size_t> m_next{0};
+	};
+
+	thread_local bool Pool::t_inPool = false;
+
+	Pool& pool() {
+		static Pool p;
+		return p;
+	}
+}
+
+int Parallel::threadCount() {
+	return pool().threadCount();
+}
+
+void Parallel::forRange(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn) {
+	if (count == 0) return;
+	grain = std::max<size_t>(1, grain);
+	// Small loops and nested calls aren't worth waking the workers for.
+	if (count <= grain || Pool::t_inPool || pool().threadCount() == 1 || !pool().tryRun(count, grain, fn)) {
+		fn(0, count);
+	}
+}
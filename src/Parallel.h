@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+// Small fork-join pool for data-parallel loops (solver phases over independent curves).
+//
+// forRange splits [0, count) into chunks of `grain` items and runs fn(begin, end) for each chunk on the
+// pool's workers and the calling thread, returning once every chunk is done. The pool serves one loop
+// at a time: a call made while another thread is inside forRange, or from inside a chunk, runs inline
+// on the caller instead of waiting. fn must not throw.
+namespace Parallel {
+	// Threads a forRange call can use, including the caller.
+	int threadCount();
+
+	void forRange(size_t count, size_t grain, const std::function<void(size_t, size_t)>& fn);
+}
@@ -6,7 +6,15 @@
 #include "Bvh.h"
 
 #include "Log.h"
-
+#include "Parallel.h"
+#include "Profiler.h"
+#include "UniformGrid.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 static bool rayTriMT(const glm::vec3& ro, const glm::vec3& rd,
@@ -75,6 +83,187 @@ static void solveDistance(glm::vec3& p0, glm::vec3& p1, float restLen, float w0,
 	p1 += corr * (-w1);
 }
 
+// XPBD distance constraint (Macklin et al. 2016). lambda accumulates over the iterations of one step,
+// and alphaTilde = compliance / dt^2, so the converged stiffness doesn't depend on the iteration count.
+// With zero compliance this is the same update as solveDistance at full stiffness.
+static void solveDistanceXpbd(glm::vec3& p0, glm::vec3& p1, float restLen, float w0, float w1, float alphaTilde, float& lambda) {
+	glm::vec3 d = p1 - p0;
+	float len = glm::length(d);
+	if (len < 1e-8f) return;
+	float wsum = w0 + w1;
+	if (wsum <= 0.0f) return;
+	glm::vec3 n = d / len;
+	float C = len - restLen;
+	float dLambda = (-C - alphaTilde * lambda) / (wsum + alphaTilde);
+	lambda += dLambda;
+	p0 -= n * (dLambda * w0);
+	p1 += n * (dLambda * w1);
+}
+
+// One Gauss-Seidel sweep over a strand's stretch constraints, root to tip.
+static void solveStretchChainGaussSeidel(std::vector<glm::vec3>& p, float restLen, int pinnedDrag) {
+	for (size_t i = 0; i + 1 < p.size(); i++) {
+		float w0 = (i == 0) ? 0.0f : 1.0f;
+		float w1 = 1.0f;
+		if (pinnedDrag >= 0) {
+			if ((int)i == pinnedDrag) w0 = 0.0f;
+			if ((int)(i + 1) == pinnedDrag) w1 = 0.0f;
+			if (w0 + w1 <= 0.0f) continue;
+		}
+		// Stretch constraints are always full-strength (hair is inextensible)
+		solveDistance(p[i], p[i + 1], restLen, w0, w1, 1.0f);
+	}
+}
+
+// Stretch below this RMS fraction of the rest length counts as solved.
+static const float kDirectStretchTolerance = 1e-5f;
+
+// Solves all stretch constraints of one strand together instead of one after another. The chain's
+// constraint system J W J^T dLambda = -C is tridiagonal (constraint i only shares a particle with i-1 and
+// i+1), so a Thomas-algorithm pass gives the Newton step for the whole strand, where Gauss-Seidel needs
+// many iterations to carry a correction down a long strand. The linearisation is poor on long kinked
+// strands, so it takes a few solver iterations to converge rather than one.
+static void solveStretchChainDirect(std::vector<glm::vec3>& p, float restLen, int pinnedDrag) {
+	const size_t m = (p.size() >= 2) ? p.size() - 1 : 0; // constraint count
+	if (m == 0) return;
+
+	struct Scratch {
+		std::vector<glm::vec3> n, dx;
+		std::vector<float> lower, diag, upper, rhs;
+	};
+	static thread_local Scratch s;
+	s.n.resize(m);
+	s.lower.resize(m);
+	s.diag.resize(m);
+	s.upper.resize(m);
+	s.rhs.resize(m);
+	s.dx.resize(p.size());
+
+	auto invMass = [&](size_t i) -> float {
+		if (i == 0 || (int)i == pinnedDrag) return 0.0f;
+		return 1.0f;
+	};
+
+	float errorSq = 0.0f;
+	for (size_t i = 0; i < m; i++) {
+		glm::vec3 d = p[i + 1] - p[i];
+		float len = glm::length(d);
+		s.n[i] = (len > 1e-8f) ? d / len : glm::vec3(0.0f);
+		s.rhs[i] = (len > 1e-8f) ? -(len - restLen) : 0.0f;
+		errorSq += s.rhs[i] * s.rhs[i];
+	}
+	const float tolerance = kDirectStretchTolerance * restLen;
+	if (errorSq <= (float)m * tolerance * tolerance) return;
+
+	// A drag past the strand's reach has no solution for Newton to converge to; the Gauss-Seidel sweep settles
+	// on a compromise instead of oscillating.
+	if (pinnedDrag > 0 && glm::length(p[(size_t)pinnedDrag] - p[0]) > (float)pinnedDrag * restLen) {
+		solveStretchChainGaussSeidel(p, restLen, pinnedDrag);
+		return;
+	}
+
+	for (size_t i = 0; i < m; i++) {
+		const float w0 = invMass(i);
+		const float w1 = invMass(i + 1);
+		s.diag[i] = w0 + w1;
+		// Neighbouring constraints couple through their shared particle.
+		s.lower[i] = (i > 0) ? -w0 * glm::dot(s.n[i - 1], s.n[i]) : 0.0f;
+		s.upper[i] = (i + 1 < m) ? -w1 * glm::dot(s.n[i], s.n[i + 1]) : 0.0f;
+		if (s.diag[i] <= 1e-8f || glm::dot(s.n[i], s.n[i]) == 0.0f) {
+			// Both ends fixed (or degenerate): leave this constraint out of the system.
+			s.diag[i] = 1.0f;
+			s.lower[i] = 0.0f;
+			s.upper[i] = 0.0f;
+			s.rhs[i] = 0.0f;
+		}
+	}
+
+	// Thomas algorithm (forward sweep, back substitution); rhs ends up holding dLambda.
+	for (size_t i = 1; i < m; i++) {
+		const float k = s.lower[i] / s.diag[i - 1];
+		s.diag[i] -= k * s.upper[i - 1];
+		s.rhs[i] -= k * s.rhs[i - 1];
+	}
+	s.rhs[m - 1] /= s.diag[m - 1];
+	for (size_t i = m - 1; i-- > 0;) {
+		s.rhs[i] = (s.rhs[i] - s.upper[i] * s.rhs[i + 1]) / s.diag[i];
+	}
+
+	// dx = W J^T dLambda: particle j is pulled by the constraints on both sides.
+	s.dx[0] = glm::vec3(0.0f);
+	float maxMoveSq = 0.0f;
+	for (size_t j = 1; j < p.size(); j++) {
+		const float w = invMass(j);
+		glm::vec3 dx(0.0f);
+		if (w > 0.0f) {
+			dx = s.n[j - 1] * s.rhs[j - 1];
+			if (j < m) dx -= s.n[j] * s.rhs[j];
+			dx *= w;
+		}
+		s.dx[j] = dx;
+		maxMoveSq = std::max(maxMoveSq, glm::dot(dx, dx));
+	}
+
+	// On a long strand with a kink the multipliers grow with the strand's length, and the step can swing
+	// particles sideways by more than a segment, which the linearisation doesn't model. Capping the largest
+	// move at one rest length keeps such steps sane. The error can still rise for one step before Newton
+	// settles, so there is no line search on it: one that required a decrease stalled long strands.
+	const float t = (maxMoveSq > restLen * restLen) ? restLen / std::sqrt(maxMoveSq) : 1.0f;
+	for (size_t j = 1; j < p.size(); j++) p[j] += s.dx[j] * t;
+}
+
+// Rest-shape bending (rod model): walks the strand root to tip carrying a parallel-transported frame and
+// pulls each vertex toward where its rest direction, expressed in that frame, puts it. Unlike the
+// second-neighbour distance constraint this keeps curl and styled shapes, including their direction.
+// Local constraints alone sag on long strands (every joint gives a little under the weight below it), so
+// `hold` also pulls each vertex toward its rest position relative to the root, as in global shape matching.
+static void solveRestShape(HairCurve& c, const glm::mat3& rootFrame, float stiffness, float hold, int pinnedDrag) {
+	const size_t n = c.points.size();
+	if (c.restLocal.size() != n) return;
+	std::vector<glm::vec3>& p = c.points;
+	const float rest = c.segmentRestLen;
+	glm::mat3 frame = rootFrame;
+	glm::mat3 restFrame = rootFrame;
+	glm::vec3 restPos = p[0];
+	for (size_t i = 1; i < n; i++) {
+		const glm::vec3 restSeg = restFrame * c.restLocal[i] * rest;
+		restPos += restSeg;
+		HairGuideSet::transportFrame(restFrame, restSeg);
+		if (hold > 0.0f && (int)i != pinnedDrag) p[i] += (restPos - p[i]) * hold;
+
+		const float w0 = (i - 1 == 0 || (int)(i - 1) == pinnedDrag) ? 0.0f : 1.0f;
+		const float w1 = ((int)i == pinnedDrag) ? 0.0f : 1.0f;
+		const float wsum = w0 + w1;
+		if (wsum > 0.0f) {
+			const glm::vec3 target = p[i - 1] + frame * c.restLocal[i] * rest;
+			const glm::vec3 d = (target - p[i]) * (stiffness / wsum);
+			p[i] += d * w1;
+			p[i - 1] -= d * w0;
+		}
+		HairGuideSet::transportFrame(frame, p[i] - p[i - 1]);
+	}
+}
+
+// Sleeping: a curve must stay under the energy threshold this many steps in a row (a quarter second at
+// 120 Hz) so a strand momentarily at rest at the top of a swing isn't put to sleep.
+static const int kStepsToSleep = 30;
+// Solver phases run in parallel over chunks of this many curves.
+static const size_t kCurvesPerTask = 32;
+
+// A sleeping curve wakes once any of its points is this far (m) from where it fell asleep.
+static const float kWakeDistance = 1e-5f;
+
+// Compares point by point, so moves that keep the centroid (a rotation, symmetric smoothing) and slow
+// drift both wake the curve.
+static bool movedSinceSleep(const HairCurve& c) {
+	if (c.sleep.points.size() != c.points.size()) return true;
+	for (size_t i = 0; i < c.points.size(); i++) {
+		const glm::vec3 d = c.points[i] - c.sleep.points[i];
+		if (!(glm::dot(d, d) <= kWakeDistance * kWakeDistance)) return true; // NaN counts as moved
+	}
+	return false;
+}
+
 static void integrateVerlet(std::vector<glm::vec3>& p, std::vector<glm::vec3>& prev, float dt, const glm::vec3& acc, int pinnedIndex, float damping) {
 	float dt2 = dt * dt;
 	for (size_t i = 0; i < p.size(); i++) {
@@ -97,48 +286,82 @@ static void integrateVerlet2Pinned(std::vector<glm::vec3>& p, std::vector<glm::v
 	}
 }
 
-void Physics::step(Scene& scene, float dt) {
-	if (dt <= 0.0f) return;
-	if (!scene.mesh()) return;
-
-	static const Mesh* cachedMesh = nullptr;
-	static Bvh meshBvh;
-	if (cachedMesh != scene.mesh()) {
-		meshBvh.build(*scene.mesh());
-		cachedMesh = scene.mesh();
-	}
-
-	// DEBUG: Check state on first call
-	static int callCount = 0;
-	callCount++;
-	
-	// Update roots BEFORE integration to ensure zero initial velocity
-	scene.guides().updatePinnedRootsFromMesh(*scene.mesh());
-
-	GuideSettings& gs = scene.guideSettings();
-
-	const bool dragging = scene.isDragging();
-	const int dragCurve = scene.dragCurve();
-	const int dragVert = scene.dragVert();
-
-	for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) {
-		if (!scene.guides().isCurveSelected(ci)) {
-			continue; // freeze unselected curves
-		}
-
-		// Mesh positions are already scaled to meters at import time, so gravity is standard m/s^2.
-		float g = glm::max(0.0f, scene.effectiveGravityForCurve(ci));
-		glm::vec3 gravity(0.0f, -g, 0.0f);
+// Continuous collision for one point moving from start to p this step: if the path crosses the mesh,
+// stop it on the side it came from (thickness off the surface) with the same response as the pushout.
+// Points that started inside (already tunneled) are left to the pushout so they can get out.
+static void sweepAgainstMesh(const Mesh& mesh, const Bvh& bvh, const glm::vec3& start, glm::vec3& p, glm::vec3& prev, float thickness, float friction) {
+	int tri = -1;
+	float t = 0.0f;
+	glm::vec3 n;
+	if (!bvh.sweepSegment(start, p, tri, t, n)) return;
+	if (isInsideMeshRayParity(mesh, bvh, start)) return;
+
+	const glm::vec3 hit = start + (p - start) * t;
+	const glm::vec3 nrm = (glm::dot(start - hit, n) >= 0.0f) ? n : -n;
+	p = hit + nrm * thickness;
+	const glm::vec3 v = p - prev;
+	const glm::vec3 vT = v - glm::dot(v, nrm) * nrm;
+	prev = p - vT * (1.0f - friction);
+}
 
-		HairCurve& c = scene.guides().curve(ci);
+void Physics::stepCurves(const StepContext& ctx, float dt, std::vector<int>* outCorrupted, StepStats* outStats) {
+	if (dt <= 0.0f) return;
+	if (!ctx.mesh || !ctx.bvh || !ctx.settings) return;
+	HT_TRACE_SCOPE("Physics::step");
+
+	const Mesh& mesh = *ctx.mesh;
+	const Bvh& meshBvh = *ctx.bvh;
+	const GuideSettings& gs = *ctx.settings;
+
+	// Curves don't interact until curve-curve collision at the end, so each solver phase runs as a
+	// loop over all active curves, split across the thread pool. Per-curve results are identical to
+	// solving curve by curve on one thread, and the phases can be timed without a clock read per curve.
+	struct ActiveCurve {
+		HairCurve* curve;
+		int pinnedDrag;
+		glm::vec3 gravity;
+		size_t lambdaOffset;   // first bend multiplier of this curve (XPBD)
+		size_t pointOffset;    // first step-start position of this curve (continuous collision)
+		bool rod;              // has a rest shape and a valid root frame
+		glm::mat3 rootFrame;
+	};
+	std::vector<ActiveCurve> active;
+	active.reserve(ctx.curves.size());
+	size_t lambdaCount = 0;
+	size_t pointCount = 0;
+	int sleepingCount = 0;
+	// Curve-curve collision sees the awake and sleeping curves, never the corrupted ones.
+	std::vector<HairCurve*> collisionCurves;
+	if (gs.enableCurveCollision) collisionCurves.reserve(ctx.curves.size());
+
+	for (size_t ci = 0; ci < ctx.curves.size(); ci++) {
+		HairCurve& c = *ctx.curves[ci];
 		if (c.points.size() < 2) continue;
 
+		// Update roots BEFORE integration to ensure zero initial velocity
+		HairGuideSet::updatePinnedRoot(c, mesh);
+
 		// HTML spiderweb invariant: prevPos starts equal to pos.
 		// Enforce the same here defensively (prevents garbage velocities).
 		if (c.prevPoints.size() != c.points.size()) {
 			c.prevPoints = c.points;
 		}
 
+		// Mesh positions are already scaled to meters at import time, so gravity is standard m/s^2.
+		const float g = glm::max(0.0f, (ci < ctx.gravity.size()) ? ctx.gravity[ci] : gs.gravity);
+		const int pinnedDrag = ((int)ci == ctx.dragCurve) ? ctx.dragVert : -1;
+
+		// Sleeping curves are skipped until disturbed: dragged, moved from outside (edits, root motion,
+		// a push from an awake neighbour), or their gravity changes.
+		if (c.sleep.sleeping) {
+			if (gs.enableSleeping && pinnedDrag < 0 && g == c.sleep.gravity && !movedSinceSleep(c)) {
+				sleepingCount++;
+				if (gs.enableCurveCollision) collisionCurves.push_back(&c);
+				continue;
+			}
+			c.sleep = HairCurveSleep();
+		}
+
 		// Kill obviously corrupted velocities (prevents instant drift to infinity).
 		// Threshold is in m/s (world units). With dt~=0.001, 50 m/s => 5cm per substep.
 		const float maxReasonableSpeed = 50.0f;
@@ -152,108 +375,194 @@ void Physics::step(Scene& scene, float dt) {
 
 		// Diagnostic: check for NaN or inf positions before integration
 		bool hasInvalid = false;
-		size_t invalidIdx = 0;
 		for (size_t i = 0; i < c.points.size(); i++) {
 			if (glm::any(glm::isnan(c.points[i])) || glm::any(glm::isinf(c.points[i]))) {
 				hasInvalid = true;
-				invalidIdx = i;
 				HT_WARN("ERROR: Curve %zu vertex %zu has NaN/inf: (%.3f, %.3f, %.3f)\n", 
 				       ci, i, c.points[i].x, c.points[i].y, c.points[i].z);
 				break;
 			}
 		}
 		if (hasInvalid) {
-			// Reset this curve to prevent further corruption
-			HT_WARN("Removing corrupted curve %zu\n", ci);
-			scene.guides().removeCurve((int)ci);
+			// The caller owns the curve list and removes these after the step.
+			if (outCorrupted) outCorrupted->push_back((int)ci);
 			continue;
 		}
 
-		// Verlet integration with damping (like spiderweb)
+		glm::mat3 frame(1.0f);
+		const bool rod = gs.rodBending && c.restLocal.size() == c.points.size() && HairGuideSet::rootFrame(c, mesh, frame);
+		active.push_back({&c, pinnedDrag, glm::vec3(0.0f, -g, 0.0f), lambdaCount, pointCount, rod, frame});
+		if (gs.enableCurveCollision) collisionCurves.push_back(&c);
+		lambdaCount += c.points.size() - 2;
+		pointCount += c.points.size();
+	}
+
+	// Continuous collision sweeps each point from its last resolved position (the start of the step, then
+	// where the previous iteration's collision pass left it) to where the solver put it. prevPoints can't
+	// be used for the start: collision response rewrites it to set the velocity.
+	const bool sweep = gs.enableMeshCollision && gs.continuousCollision;
+	static thread_local std::vector<glm::vec3> stepStart;
+	if (sweep) stepStart.resize(pointCount);
+	glm::vec3* const startBase = stepStart.data();
+
+	// Verlet integration with damping (like spiderweb)
+	{
+		HT_PROFILE_SCOPE(Integrate);
 		const float dampingFactor = glm::clamp(gs.damping, 0.0f, 1.0f);
 		const int pinnedRoot = 0;
-		const int pinnedDrag = (dragging && (int)ci == dragCurve) ? dragVert : -1;
-		if (pinnedDrag >= 0) {
-			// While dragging, pin the dragged vertex so constraints can't fight the mouse.
-			c.prevPoints[(size_t)pinnedDrag] = c.points[(size_t)pinnedDrag];
-			integrateVerlet2Pinned(c.points, c.prevPoints, dt, gravity, pinnedRoot, pinnedDrag, dampingFactor);
-		} else {
-			integrateVerlet(c.points, c.prevPoints, dt, gravity, pinnedRoot, dampingFactor);
-		}
-
-		// Constraints
-		int iters = glm::clamp(gs.solverIterations, 1, 64);
-		float rest = c.segmentRestLen;
-		if (rest <= 0.0f) {
-			rest = gs.defaultLength / (float)(glm::max(2, (int)c.points.size()) - 1);
-			c.segmentRestLen = rest;
-		}
-
-		float bendStiffness = glm::clamp(gs.stiffness, 0.0f, 1.0f);
-		for (int it = 0; it < iters; it++) {
-			// distance constraints
-			for (size_t i = 0; i + 1 < c.points.size(); i++) {
-				float w0 = (i == 0) ? 0.0f : 1.0f;
-				float w1 = 1.0f;
-				if (pinnedDrag >= 0) {
-					if ((int)i == pinnedDrag) w0 = 0.0f;
-					if ((int)(i + 1) == pinnedDrag) w1 = 0.0f;
-					if (w0 + w1 <= 0.0f) continue;
+		Parallel::forRange(active.size(), kCurvesPerTask, [&](size_t begin, size_t end) {
+			for (size_t ai = begin; ai < end; ai++) {
+				const ActiveCurve& ac = active[ai];
+				HairCurve& c = *ac.curve;
+				if (sweep) std::copy(c.points.begin(), c.points.end(), startBase + ac.pointOffset);
+				if (ac.pinnedDrag >= 0 && (size_t)ac.pinnedDrag < c.points.size()) {
+					// While dragging, pin the dragged vertex so constraints can't fight the mouse.
+					c.prevPoints[(size_t)ac.pinnedDrag] = c.points[(size_t)ac.pinnedDrag];
+					integrateVerlet2Pinned(c.points, c.prevPoints, dt, ac.gravity, pinnedRoot, ac.pinnedDrag, dampingFactor);
+				} else {
+					integrateVerlet(c.points, c.prevPoints, dt, ac.gravity, pinnedRoot, dampingFactor);
+				}
+				if (c.segmentRestLen <= 0.0f) {
+					c.segmentRestLen = gs.defaultLength / (float)(glm::max(2, (int)c.points.size()) - 1);
 				}
-				// Stretch constraints are always full-strength (hair is inextensible)
-				solveDistance(c.points[i], c.points[i + 1], rest, w0, w1, 1.0f);
 			}
+		});
+	}
 
-			// Bend stiffness (second-neighbor distance). This resists sharp kinks without allowing stretch.
-			if (bendStiffness > 0.0f) {
-				for (size_t i = 0; i + 2 < c.points.size(); i++) {
-					float w0 = (i == 0) ? 0.0f : 1.0f;
-					float w2 = 1.0f;
-					if (pinnedDrag >= 0) {
-						if ((int)i == pinnedDrag) w0 = 0.0f;
-						if ((int)(i + 2) == pinnedDrag) w2 = 0.0f;
-						if (w0 + w2 <= 0.0f) continue;
+	// Constraints
+	const int iters = glm::clamp((ctx.iterations > 0) ? ctx.iterations : gs.solverIterations, 1, 64);
+	const float bendStiffness = glm::clamp(gs.stiffness, 0.0f, 1.0f);
+	const bool xpbd = gs.useXpbd;
+	const bool directStretch = gs.directStretchSolve;
+	const float bendAlphaTilde = glm::max(0.0f, gs.bendCompliance) / (dt * dt);
+	// Per-iteration factors that reach shapeStiffness/shapeHold after all iterations, so the rod model's
+	// stiffness doesn't change with the iteration count.
+	const float shapeStiffness = glm::clamp(gs.shapeStiffness, 0.0f, 1.0f);
+	const float shapeK = 1.0f - std::pow(1.0f - shapeStiffness, 1.0f / (float)iters);
+	const float shapeHold = glm::clamp(gs.shapeHold, 0.0f, 1.0f);
+	const float holdK = 1.0f - std::pow(1.0f - shapeHold, 1.0f / (float)iters);
+	// Multipliers live for one step; thread_local so the simulation thread doesn't reallocate every step.
+	static thread_local std::vector<float> bendLambda;
+	if (xpbd) bendLambda.assign(lambdaCount, 0.0f);
+	float* const lambdaBase = bendLambda.data(); // the workers' own bendLambda would be empty
+#if HAIRTOOL_ENABLE_PROFILER
+	// BVH query counters are per thread, so each collision chunk hands over its thread's counts.
+	std::mutex queryStatsMutex;
+	Bvh::QueryStats queryStats;
+#endif
+	for (int it = 0; it < iters; it++) {
+		{
+			HT_PROFILE_SCOPE(Constraints);
+			Parallel::forRange(active.size(), kCurvesPerTask, [&](size_t begin, size_t end) {
+				for (size_t ai = begin; ai < end; ai++) {
+					const ActiveCurve& ac = active[ai];
+					HairCurve& c = *ac.curve;
+					const float rest = c.segmentRestLen;
+					const int pinnedDrag = ac.pinnedDrag;
+
+					// distance constraints
+					if (directStretch) {
+						solveStretchChainDirect(c.points, rest, pinnedDrag);
+					} else {
+						solveStretchChainGaussSeidel(c.points, rest, pinnedDrag);
+					}
+
+					// Bend stiffness (second-neighbor distance). This resists sharp kinks without allowing stretch.
+					if (ac.rod) {
+						if (shapeK > 0.0f || holdK > 0.0f) solveRestShape(c, ac.rootFrame, shapeK, holdK, pinnedDrag);
+					} else if (xpbd) {
+						float* lambda = lambdaBase + ac.lambdaOffset;
+						for (size_t i = 0; i + 2 < c.points.size(); i++) {
+							float w0 = (i == 0) ? 0.0f : 1.0f;
+							float w2 = 1.0f;
+							if (pinnedDrag >= 0) {
+								if ((int)i == pinnedDrag) w0 = 0.0f;
+								if ((int)(i + 2) == pinnedDrag) w2 = 0.0f;
+								if (w0 + w2 <= 0.0f) continue;
+							}
+							solveDistanceXpbd(c.points[i], c.points[i + 2], rest * 2.0f, w0, w2, bendAlphaTilde, lambda[i]);
+						}
+					} else if (bendStiffness > 0.0f) {
+						for (size_t i = 0; i + 2 < c.points.size(); i++) {
+							float w0 = (i == 0) ? 0.0f : 1.0f;
+							float w2 = 1.0f;
+							if (pinnedDrag >= 0) {
+								if ((int)i == pinnedDrag) w0 = 0.0f;
+								if ((int)(i + 2) == pinnedDrag) w2 = 0.0f;
+								if (w0 + w2 <= 0.0f) continue;
+							}
+							solveDistance(c.points[i], c.points[i + 2], rest * 2.0f, w0, w2, bendStiffness);
+						}
 					}
-					solveDistance(c.points[i], c.points[i + 2], rest * 2.0f, w0, w2, bendStiffness);
 				}
-			}
+			});
+		}
 
-			// OBJ mesh collision: nearest-triangle pushout with thickness.
-			if (gs.enableMeshCollision) {
-				float thickness = glm::max(1e-6f, gs.collisionThickness);
-				for (size_t i = 1; i < c.points.size(); i++) {
-					int tri = -1;
-					glm::vec3 cp, n;
-					if (!meshBvh.nearestTriangle(c.points[i], tri, cp, n, thickness * 2.0f)) continue;
-					glm::vec3 d = c.points[i] - cp;
-					float dist = glm::length(d);
-					if (dist < thickness) {
-						bool inside = isInsideMeshRayParity(*scene.mesh(), meshBvh, c.points[i]);
-						glm::vec3 pushDir;
-						if (dist >= 1e-8f) {
-							pushDir = inside ? -glm::normalize(d) : glm::normalize(d);
-						} else {
-							// Degenerate: push along triangle normal, try to push outward by checking which direction increases distance.
-							pushDir = inside ? n : n;
+		// OBJ mesh collision: nearest-triangle pushout with thickness.
+		if (gs.enableMeshCollision) {
+			HT_PROFILE_SCOPE(MeshCollision);
+			const float thickness = glm::max(1e-6f, gs.collisionThickness);
+			const float fr = glm::clamp(gs.collisionFriction, 0.0f, 1.0f);
+			Parallel::forRange(active.size(), kCurvesPerTask, [&](size_t begin, size_t end) {
+				for (size_t ai = begin; ai < end; ai++) {
+					const ActiveCurve& ac = active[ai];
+					HairCurve& c = *ac.curve;
+					glm::vec3* start = sweep ? startBase + ac.pointOffset : nullptr;
+					if (c.meshCache.size() != c.points.size()) c.meshCache.assign(c.points.size(), Bvh::NearestCache());
+					for (size_t i = 1; i < c.points.size(); i++) {
+						// Moves shorter than the thickness end inside the pushout band below; longer ones may
+						// have crossed a surface (an ear) and landed where the nearest triangle is on the far side.
+						// Small moves add up until they reach the thickness and are swept together.
+						if (sweep && (int)i != ac.pinnedDrag) {
+							const glm::vec3 move = c.points[i] - start[i];
+							if (glm::dot(move, move) > thickness * thickness) {
+								sweepAgainstMesh(mesh, meshBvh, start[i], c.points[i], c.prevPoints[i], thickness, fr);
+								start[i] = c.points[i];
+							}
+						}
+						int tri = -1;
+						glm::vec3 cp, n;
+						// Points barely move between iterations and substeps, so the query is usually answered
+						// from the triangles around the previous result (same answer as a full query).
+						if (!meshBvh.nearestTriangleCached(c.points[i], thickness * 2.0f, thickness, c.meshCache[i], tri, cp, n)) continue;
+						glm::vec3 d = c.points[i] - cp;
+						float dist = glm::length(d);
+						if (dist < thickness) {
+							bool inside = isInsideMeshRayParity(mesh, meshBvh, c.points[i]);
+							glm::vec3 pushDir;
+							if (dist >= 1e-8f) {
+								pushDir = inside ? -glm::normalize(d) : glm::normalize(d);
+							} else {
+								// Degenerate: push along triangle normal, try to push outward by checking which direction increases distance.
+								pushDir = inside ? n : n;
+							}
+							c.points[i] += pushDir * (thickness - dist);
+							// Collision response: remove normal velocity and apply friction to tangential velocity.
+							// friction=0 => keep tangential velocity (slide), friction=1 => fully sticky.
+							glm::vec3 nrm = pushDir;
+							float nl = glm::length(nrm);
+							if (nl > 1e-8f) nrm /= nl;
+							glm::vec3 v = c.points[i] - c.prevPoints[i];
+							glm::vec3 vN = glm::dot(v, nrm) * nrm;
+							glm::vec3 vT = v - vN;
+							glm::vec3 vNew = vT * (1.0f - fr);
+							c.prevPoints[i] = c.points[i] - vNew;
 						}
-						c.points[i] += pushDir * (thickness - dist);
-						// Collision response: remove normal velocity and apply friction to tangential velocity.
-						// friction=0 => keep tangential velocity (slide), friction=1 => fully sticky.
-						glm::vec3 nrm = pushDir;
-						float nl = glm::length(nrm);
-						if (nl > 1e-8f) nrm /= nl;
-						glm::vec3 v = c.points[i] - c.prevPoints[i];
-						glm::vec3 vN = glm::dot(v, nrm) * nrm;
-						glm::vec3 vT = v - vN;
-						float fr = glm::clamp(gs.collisionFriction, 0.0f, 1.0f);
-						glm::vec3 vNew = vT * (1.0f - fr);
-						c.prevPoints[i] = c.points[i] - vNew;
 					}
 				}
-			}
+#if HAIRTOOL_ENABLE_PROFILER
+				const Bvh::QueryStats q = Bvh::takeThreadQueryStats();
+				std::lock_guard<std::mutex> lock(queryStatsMutex);
+				queryStats += q;
+#endif
+			});
 		}
+	}
 
-		// Diagnostic: check velocities and positions after all constraints
+#if defined(HAIRTOOL_VERBOSE_LOGGING) && (HAIRTOOL_VERBOSE_LOGGING)
+	// Diagnostic: check velocities and positions after all constraints
+	for (const ActiveCurve& ac : active) {
+		const HairCurve& c = *ac.curve;
 		float maxVel = 0.0f;
 		float maxDist = 0.0f;
 		for (size_t i = 0; i < c.points.size(); i++) {
@@ -268,37 +577,193 @@ void Physics::step(Scene& scene, float dt) {
 			// Only print every 60 frames to reduce spam
 			static int warnCounter = 0;
 			if (warnCounter++ % 60 == 0) {
-				HT_WARN("WARNING: Curve %zu - maxVel=%.2f m/s, maxDist=%.2f m (may disappear soon)\n", ci, maxVel, maxDist);
+				HT_WARN("WARNING: Curve - maxVel=%.2f m/s, maxDist=%.2f m (may disappear soon)\n", maxVel, maxDist);
 			}
 		}
 	}
+#endif
+
+	if (gs.enableCurveCollision) {
+		applyCurveCurveCollision(collisionCurves, gs);
+	}
+
+	// Put curves to sleep once their kinetic energy (per unit mass, mean over the free points) has
+	// stayed under the threshold for kStepsToSleep steps.
+	if (gs.enableSleeping) {
+		const float threshold = glm::max(0.0f, gs.sleepThreshold);
+		const float energyScale = 0.5f / (dt * dt);
+		Parallel::forRange(active.size(), kCurvesPerTask, [&](size_t begin, size_t end) {
+			for (size_t ai = begin; ai < end; ai++) {
+				const ActiveCurve& ac = active[ai];
+				HairCurve& c = *ac.curve;
+				if (ac.pinnedDrag >= 0) {
+					c.sleep.stillSteps = 0;
+					continue;
+				}
+				float sumV2 = 0.0f;
+				for (size_t i = 1; i < c.points.size(); i++) {
+					const glm::vec3 v = c.points[i] - c.prevPoints[i];
+					sumV2 += glm::dot(v, v);
+				}
+				const float energy = sumV2 * energyScale / (float)(c.points.size() - 1);
+				if (energy >= threshold) {
+					c.sleep.stillSteps = 0;
+					continue;
+				}
+				if (++c.sleep.stillSteps < kStepsToSleep) continue;
+				c.sleep.sleeping = true;
+				c.sleep.gravity = -ac.gravity.y;
+				c.sleep.points = c.points;
+				c.prevPoints = c.points;
+			}
+		});
+	}
 
-	applyCurveCurveCollision(scene);
+	if (outStats) {
+		// Residual stretch left after the iterations; what the adaptive scheduler watches for quality.
+		double sum = 0.0;
+		size_t segments = 0;
+		size_t particles = 0;
+		for (const ActiveCurve& ac : active) {
+			const HairCurve& c = *ac.curve;
+			particles += c.points.size();
+			const float rest = c.segmentRestLen;
+			if (rest <= 0.0f) continue;
+			for (size_t i = 0; i + 1 < c.points.size(); i++) {
+				const float e = (glm::length(c.points[i + 1] - c.points[i]) - rest) / rest;
+				sum += (double)(e * e);
+			}
+			segments += c.points.size() - 1;
+		}
+		outStats->simulatedCurves = (int)active.size();
+		outStats->sleepingCurves = sleepingCount;
+		outStats->simulatedParticles = (int)particles;
+		outStats->stretchError = (segments > 0) ? (float)std::sqrt(sum / (double)segments) : 0.0f;
+	}
+
+#if HAIRTOOL_ENABLE_PROFILER
+	if (Trace::enabled()) {
+		Bvh::QueryStats q = queryStats;
+		q += Bvh::takeThreadQueryStats();
+		HT_TRACE_COUNTER("bvh_nearest_queries", q.nearestQueries);
+		HT_TRACE_COUNTER("bvh_cached_queries", q.cachedQueries);
+		HT_TRACE_COUNTER("bvh_raycasts", q.raycasts);
+		HT_TRACE_COUNTER("bvh_nodes_visited", q.nodesVisited);
+		HT_TRACE_COUNTER("simulated_curves", active.size());
+		HT_TRACE_COUNTER("sleeping_curves", sleepingCount);
+	}
+#endif
+}
+
+void Physics::step(Scene& scene, float dt, int iterations, StepStats* outStats) {
+	if (dt <= 0.0f) return;
+	if (!scene.mesh() || !scene.meshBvh()) return;
+
+	StepContext ctx;
+	ctx.mesh = scene.mesh();
+	ctx.bvh = scene.meshBvh();
+	ctx.settings = &scene.guideSettings();
+	ctx.iterations = iterations;
+	std::vector<int> sceneIndex;
+	for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) {
+		if (!scene.isCurveSimulated(ci)) {
+			continue; // freeze curves outside the simulated set
+		}
+		if (scene.isDragging() && (int)ci == scene.dragCurve()) {
+			ctx.dragCurve = (int)ctx.curves.size();
+			ctx.dragVert = scene.dragVert();
+		}
+		ctx.curves.push_back(&scene.guides().curve(ci));
+		ctx.gravity.push_back(scene.effectiveGravityForCurve(ci));
+		sceneIndex.push_back((int)ci);
+	}
+
+	std::vector<int> corrupted;
+	stepCurves(ctx, dt, &corrupted, outStats);
+
+	if (!corrupted.empty()) {
+		HT_WARN("Removing %zu corrupted curve(s)\n", corrupted.size());
+		std::vector<int> toRemove;
+		for (int i = (int)corrupted.size() - 1; i >= 0; i--) toRemove.push_back(sceneIndex[(size_t)corrupted[(size_t)i]]);
+		scene.guides().removeCurves(toRemove);
+	}
 }
 
 void Physics::applyCurveCurveCollision(Scene& scene) {
-	GuideSettings& gs = scene.guideSettings();
+	const GuideSettings& gs = scene.guideSettings();
 	if (!gs.enableCurveCollision) return;
 	if (scene.guides().curveCount() < 2) return;
 
-	float r = glm::max(1e-5f, gs.collisionThickness);
-	float r2 = r * r;
-	for (size_t a = 0; a < scene.guides().curveCount(); a++) {
-		if (!scene.guides().isCurveSelected(a)) continue;
-		for (size_t b = a + 1; b < scene.guides().curveCount(); b++) {
-			if (!scene.guides().isCurveSelected(b)) continue;
-			HairCurve& ca = scene.guides().curve(a);
-			HairCurve& cb = scene.guides().curve(b);
-			for (size_t ia = 1; ia < ca.points.size(); ia++) {
-				for (size_t ib = 1; ib < cb.points.size(); ib++) {
-					glm::vec3 d = cb.points[ib] - ca.points[ia];
-					float d2 = glm::dot(d, d);
-					if (d2 < 1e-12f || d2 > r2) continue;
-					float dist = glm::sqrt(d2);
-					glm::vec3 n = d / dist;
-					float pen = (r - dist);
-					ca.points[ia] -= n * (0.5f * pen);
-					cb.points[ib] += n * (0.5f * pen);
+	std::vector<HairCurve*> curves;
+	for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) {
+		if (scene.isCurveSimulated(ci)) curves.push_back(&scene.guides().curve(ci));
+	}
+	applyCurveCurveCollision(curves, gs);
+}
+
+void Physics::applyCurveCurveCollision(const std::vector<HairCurve*>& curves, const GuideSettings& gs) {
+	if (curves.size() < 2) return;
+	HT_PROFILE_SCOPE(CurveCollision);
+
+	const float r = glm::max(1e-5f, gs.collisionThickness);
+	const float r2 = r * r;
+	const float invCell = 1.0f / r;
+
+	// Broadphase: bucket every non-root point into a uniform grid of cell size r, so only points in the
+	// 27 surrounding cells can be in contact. Buckets are sorted runs of one array; the scratch is kept
+	// between steps. Buckets use the positions from before this pass, so a point pushed into a new cell
+	// is only found there on the next step.
+	struct Entry {
+		uint64_t cell;
+		uint32_t curve;
+		uint32_t vert;
+	};
+	static thread_local std::vector<Entry> entries;
+	static thread_local std::unordered_map<uint64_t, uint32_t> cellStart;
+
+	entries.clear();
+	for (size_t a = 0; a < curves.size(); a++) {
+		const HairCurve& c = *curves[a];
+		for (size_t i = 1; i < c.points.size(); i++) {
+			entries.push_back({UniformGrid::cellKey(UniformGrid::cellOf(c.points[i], invCell)), (uint32_t)a, (uint32_t)i});
+		}
+	}
+	std::sort(entries.begin(), entries.end(), [](const Entry& x, const Entry& y) {
+		if (x.cell != y.cell) return x.cell < y.cell;
+		if (x.curve != y.curve) return x.curve < y.curve;
+		return x.vert < y.vert;
+	});
+	cellStart.clear();
+	cellStart.reserve(entries.size());
+	for (size_t k = 0; k < entries.size(); k++) {
+		if (k == 0 || entries[k].cell != entries[k - 1].cell) cellStart.emplace(entries[k].cell, (uint32_t)k);
+	}
+
+	// Each pair is resolved once, from the curve with the lower index.
+	for (size_t a = 0; a < curves.size(); a++) {
+		HairCurve& ca = *curves[a];
+		for (size_t ia = 1; ia < ca.points.size(); ia++) {
+			const glm::ivec3 cell = UniformGrid::cellOf(ca.points[ia], invCell);
+			for (int dz = -1; dz <= 1; dz++) {
+				for (int dy = -1; dy <= 1; dy++) {
+					for (int dx = -1; dx <= 1; dx++) {
+						const uint64_t key = UniformGrid::cellKey(cell.x + dx, cell.y + dy, cell.z + dz);
+						const auto it = cellStart.find(key);
+						if (it == cellStart.end()) continue;
+						for (size_t k = it->second; k < entries.size() && entries[k].cell == key; k++) {
+							const Entry& e = entries[k];
+							if (e.curve <= (uint32_t)a) continue;
+							HairCurve& cb = *curves[e.curve];
+							glm::vec3 d = cb.points[e.vert] - ca.points[ia];
+							float d2 = glm::dot(d, d);
+							if (!(d2 >= 1e-12f && d2 <= r2)) continue; // also rejects NaN
+							float dist = glm::sqrt(d2);
+							glm::vec3 n = d / dist;
+							float pen = (r - dist);
+							ca.points[ia] -= n * (0.5f * pen);
+							cb.points[e.vert] += n * (0.5f * pen);
+						}
+					}
 				}
 			}
 		}
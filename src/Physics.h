@@ -1,10 +1,41 @@
 #pragma once
 
+#include <vector>
+
 class Scene;
+class Mesh;
+class Bvh;
+struct GuideSettings;
+struct HairCurve;
 
 namespace Physics {
+	// Everything one solver step needs, independent of Scene so it can run on a private copy of the
+	// curves (see SimulationThread).
+	struct StepContext {
+		const Mesh* mesh = nullptr;
+		const Bvh* bvh = nullptr;            // built for mesh
+		const GuideSettings* settings = nullptr;
+		std::vector<HairCurve*> curves;      // curves to simulate
+		std::vector<float> gravity;          // per curve, m/s^2 downwards
+		int dragCurve = -1;                  // index into curves whose dragVert is pinned
+		int dragVert = -1;
+		int iterations = 0;                  // constraint iterations, 0 = settings->solverIterations
+	};
+
+	struct StepStats {
+		int simulatedCurves = 0;             // awake curves that were stepped
+		int sleepingCurves = 0;              // settled curves that were skipped
+		int simulatedParticles = 0;          // points of the awake curves
+		float stretchError = 0.0f;           // RMS of |len - rest| / rest over all segments after the step
+	};
+
 	// MVP: fixed-timestep step; runs XPBD-like constraints on CPU.
 	// Future: swap implementation with YarnBall/CUDA or GL-compute backend.
-	void step(Scene& scene, float dt);
+	void step(Scene& scene, float dt, int iterations = 0, StepStats* outStats = nullptr);
+
+	// Steps ctx.curves. Curves containing NaN/inf are skipped and their indices appended to outCorrupted.
+	void stepCurves(const StepContext& ctx, float dt, std::vector<int>* outCorrupted = nullptr, StepStats* outStats = nullptr);
+
 	void applyCurveCurveCollision(Scene& scene);
+	void applyCurveCurveCollision(const std::vector<HairCurve*>& curves, const GuideSettings& settings);
 }
@@ -0,0 +1,76 @@
+#include "Profiler.h"
+
+#include <atomic>
+#include <deque>
+#include <mutex>
+
+namespace {
+	struct State {
+		std::atomic<uint64_t> phaseNs[Profiler::kPhaseCount] = {};
+		std::mutex mutex;
+		std::deque<Profiler::FrameStats> history;
+		uint64_t frameStartNs = 0;
+	};
+
+	static State& state() {
+		static State s;
+		return s;
+	}
+
+	static const char* const kPhaseNames[Profiler::kPhaseCount] = {
+		"UI", "Picking", "Tick", "Simulate", "Integrate", "Constraints", "Mesh collision", "Curve collision",
+		"Render", "Tessellation", "Upload",
+	};
+}
+
+const char* Profiler::phaseName(Phase phase) {
+	const int i = (int)phase;
+	return (i >= 0 && i < kPhaseCount) ? kPhaseNames[i] : "?";
+}
+
+int Profiler::phaseDepth(Phase phase) {
+	switch (phase) {
+		case Phase::Picking:
+		case Phase::Integrate:
+		case Phase::Constraints:
+		case Phase::MeshCollision:
+		case Phase::CurveCollision:
+		case Phase::Tessellation:
+		case Phase::Upload:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+void Profiler::record(Phase phase, uint64_t startNs, uint64_t endNs) {
+	State& s = state();
+	const int pi = (int)phase;
+	if (pi < 0 || pi >= kPhaseCount || endNs < startNs) return;
+	s.phaseNs[pi].fetch_add(endNs - startNs, std::memory_order_relaxed);
+}
+
+void Profiler::beginFrame() {
+	State& s = state();
+	const uint64_t now = nowNs();
+
+	FrameStats fs;
+	for (int i = 0; i < kPhaseCount; i++) {
+		fs.phaseMs[i] = (double)s.phaseNs[i].exchange(0, std::memory_order_relaxed) * 1e-6;
+	}
+
+	std::lock_guard<std::mutex> lock(s.mutex);
+	if (s.frameStartNs != 0) {
+		fs.frameMs = (double)(now - s.frameStartNs) * 1e-6;
+		s.history.push_back(fs);
+		while (s.history.size() > kHistoryFrames) s.history.pop_front();
+		Trace::complete("Frame", s.frameStartNs, now);
+	}
+	s.frameStartNs = now;
+}
+
+void Profiler::history(std::vector<FrameStats>& out) {
+	State& s = state();
+	std::lock_guard<std::mutex> lock(s.mutex);
+	out.assign(s.history.begin(), s.history.end());
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+// Lightweight frame profiler.
+// HT_PROFILE_SCOPE(Phase) times the enclosing scope and adds it to the current frame's per-phase totals.
+// While tracing is enabled the scope is also recorded as a trace event (see Trace.h).
+// Build with HAIRTOOL_ENABLE_PROFILER=0 to compile every scope out entirely.
+
+#include "Trace.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Profiler {
+	enum class Phase : int {
+		Ui = 0,
+		Picking,
+		Tick,
+		Simulate,
+		Integrate,
+		Constraints,
+		MeshCollision,
+		CurveCollision,
+		Render,
+		Tessellation,
+		Upload,
+		Count
+	};
+	constexpr int kPhaseCount = (int)Phase::Count;
+
+	const char* phaseName(Phase phase);
+	// Nesting depth for display (solver phases are inside Simulate, tessellation inside Render).
+	int phaseDepth(Phase phase);
+
+	struct FrameStats {
+		double frameMs = 0.0;
+		double phaseMs[kPhaseCount] = {};
+	};
+
+	constexpr bool compiledIn() { return HAIRTOOL_ENABLE_PROFILER != 0; }
+
+	inline uint64_t nowNs() { return Trace::nowNs(); }
+	void record(Phase phase, uint64_t startNs, uint64_t endNs);
+
+	// Closes the previous frame (if any) into the rolling history and starts a new one.
+	void beginFrame();
+
+	// Completed frames, oldest first (at most kHistoryFrames).
+	constexpr size_t kHistoryFrames = 240;
+	void history(std::vector<FrameStats>& out);
+
+	class Scope {
+	public:
+		explicit Scope(Phase phase) : m_phase(phase), m_traced(Trace::enabled()), m_start(nowNs()) {
+			if (m_traced) Trace::begin(phaseName(phase));
+		}
+		~Scope() {
+			record(m_phase, m_start, nowNs());
+			if (m_traced) Trace::end(phaseName(m_phase));
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		Phase m_phase;
+		bool m_traced;
+		uint64_t m_start;
+	};
+}
+
+#if HAIRTOOL_ENABLE_PROFILER
+	#define HT_PROFILE_SCOPE(phase) ::Profiler::Scope HT_TRACE_CONCAT(htProfileScope_, __LINE__)(::Profiler::Phase::phase)
+#else
+	#define HT_PROFILE_SCOPE(phase) ((void)0)
+#endif
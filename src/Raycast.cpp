@@ -104,9 +104,7 @@ bool Raycast::raycastMesh(const Mesh& mesh, const glm::vec3& ro, const glm::vec3
 
 bool Raycast::nearestOnMesh(const Mesh& mesh, const glm::vec3& p, RayHit& outHit, float maxDist) {
 	outHit = {};
-	const std::vector<glm::vec3>& pos = mesh.positions();
-	const std::vector<unsigned int>& ind = mesh.indices();
-	if (pos.empty() || ind.empty()) return false;
+	if (mesh.positions().empty() || mesh.indices().empty()) return false;
 
 	// BVH built lazily per mesh
 	static const Mesh* cachedMesh = nullptr;
@@ -115,6 +113,14 @@ bool Raycast::nearestOnMesh(const Mesh& mesh, const glm::vec3& p, RayHit& outHit
 		bvh.build(mesh);
 		cachedMesh = &mesh;
 	}
+	return nearestOnMesh(mesh, bvh, p, outHit, maxDist);
+}
+
+bool Raycast::nearestOnMesh(const Mesh& mesh, const Bvh& bvh, const glm::vec3& p, RayHit& outHit, float maxDist) {
+	outHit = {};
+	const std::vector<glm::vec3>& pos = mesh.positions();
+	const std::vector<unsigned int>& ind = mesh.indices();
+	if (pos.empty() || ind.empty()) return false;
 
 	int tri = -1;
 	glm::vec3 cp(0.0f);
@@ -3,6 +3,7 @@
 #include <glm/glm.hpp>
 
 class Mesh;
+class Bvh;
 
 struct RayHit {
 	bool hit = false;
@@ -16,4 +17,6 @@ struct RayHit {
 namespace Raycast {
 	bool raycastMesh(const Mesh& mesh, const glm::vec3& ro, const glm::vec3& rd, RayHit& outHit);
 	bool nearestOnMesh(const Mesh& mesh, const glm::vec3& p, RayHit& outHit, float maxDist = 1e30f);
+	// Same query against a BVH built for mesh; unlike the overload above it is safe to call from several threads.
+	bool nearestOnMesh(const Mesh& mesh, const Bvh& bvh, const glm::vec3& p, RayHit& outHit, float maxDist = 1e30f);
 }
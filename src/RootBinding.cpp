@@ -0,0 +1,67 @@
+#include "RootBinding.h"
+
+#include "Parallel.h"
+#include "Trace.h"
+#include "UniformGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+void RootBinding::bindRoots(const Mesh& mesh, const Bvh& bvh, const std::vector<glm::vec3>& roots, float maxDist, std::vector<RayHit>& outHits) {
+	HT_TRACE_SCOPE("RootBinding::bindRoots");
+	outHits.assign(roots.size(), RayHit());
+	// Nearest queries are independent and read-only on the BVH.
+	const size_t kRootsPerTask = 256;
+	Parallel::forRange(roots.size(), kRootsPerTask, [&](size_t begin, size_t end) {
+		for (size_t i = begin; i < end; i++) Raycast::nearestOnMesh(mesh, bvh, roots[i], outHits[i], maxDist);
+	});
+}
+
+void RootBinding::DuplicateIndex::build(const std::vector<glm::vec3>& roots, float tol) {
+	HT_TRACE_SCOPE("RootBinding::DuplicateIndex::build");
+	m_roots = roots;
+	m_claimed.assign(roots.size(), 0);
+	m_tol = tol;
+	m_invCell = 1.0f / std::max(tol, 1e-6f);
+
+	m_entries.clear();
+	m_entries.reserve(roots.size());
+	for (size_t i = 0; i < roots.size(); i++) {
+		m_entries.push_back({UniformGrid::cellKey(UniformGrid::cellOf(roots[i], m_invCell)), (uint32_t)i});
+	}
+	std::sort(m_entries.begin(), m_entries.end(), [](const Entry& a, const Entry& b) {
+		if (a.cell != b.cell) return a.cell < b.cell;
+		return a.root < b.root;
+	});
+	m_cellStart.clear();
+	m_cellStart.reserve(m_entries.size());
+	for (size_t k = 0; k < m_entries.size(); k++) {
+		if (k == 0 || m_entries[k].cell != m_entries[k - 1].cell) m_cellStart.emplace(m_entries[k].cell, (uint32_t)k);
+	}
+}
+
+int RootBinding::DuplicateIndex::claim(const glm::vec3& p) {
+	// Anything within tol lies in the 27 cells around p's cell.
+	const glm::ivec3 cell = UniformGrid::cellOf(p, m_invCell);
+	int best = -1;
+	for (int dz = -1; dz <= 1; dz++) {
+		for (int dy = -1; dy <= 1; dy++) {
+			for (int dx = -1; dx <= 1; dx++) {
+				const uint64_t key = UniformGrid::cellKey(cell.x + dx, cell.y + dy, cell.z + dz);
+				const auto it = m_cellStart.find(key);
+				if (it == m_cellStart.end()) continue;
+				for (size_t k = it->second; k < m_entries.size() && m_entries[k].cell == key; k++) {
+					const uint32_t r = m_entries[k].root;
+					if (best >= 0 && r >= (uint32_t)best) break; // runs are sorted by root index
+					if (m_claimed[r]) continue;
+					if (glm::length(m_roots[r] - p) <= m_tol) {
+						best = (int)r;
+						break;
+					}
+				}
+			}
+		}
+	}
+	if (best >= 0) m_claimed[(size_t)best] = 1;
+	return best;
+}
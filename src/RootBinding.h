@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Raycast.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+class Mesh;
+class Bvh;
+
+// Batched stages of curve import: binding every root to the mesh, and finding existing curves whose
+// root an imported curve replaces.
+namespace RootBinding {
+	// Binds each root to its nearest surface point within maxDist, spread over the worker pool.
+	// outHits[i].hit is false for roots with no surface in range.
+	void bindRoots(const Mesh& mesh, const Bvh& bvh, const std::vector<glm::vec3>& roots, float maxDist, std::vector<RayHit>& outHits);
+
+	// Existing roots bucketed in a uniform grid with cell size tol, so matching a new root looks at the
+	// 27 surrounding cells instead of every curve in the scene.
+	class DuplicateIndex {
+	public:
+		void build(const std::vector<glm::vec3>& roots, float tol);
+
+		// Lowest-index root within tol of p that hasn't been claimed yet, which is then claimed;
+		// -1 if there is none. Matches a linear scan over the roots in order.
+		int claim(const glm::vec3& p);
+
+	private:
+		struct Entry {
+			uint64_t cell;
+			uint32_t root;
+		};
+
+		std::vector<glm::vec3> m_roots;
+		std::vector<char> m_claimed;
+		std::vector<Entry> m_entries;                     // sorted by cell, then root
+		std::unordered_map<uint64_t, uint32_t> m_cellStart; // first entry of each occupied cell
+		float m_tol = 0.0f;
+		float m_invCell = 0.0f;
+	};
+}
@@ -2,6 +2,7 @@
 
 #include "Mesh.h"
 #include "Raycast.h"
+#include "Profiler.h"
 #include "Physics.h"
 #include "GpuSolver.h"
 #include "MayaCameraController.h"
@@ -96,6 +97,7 @@ void Scene::resetLayers() {
 void Scene::setLayers(const std::vector<LayerInfo>& layers, int activeLayer) {
 	if (layers.empty()) {
 		resetLayers();
+		markSimulatedSetChanged();
 		return;
 	}
 	m_layers = layers;
@@ -105,6 +107,7 @@ void Scene::setLayers(const std::vector<LayerInfo>& layers, int activeLayer) {
 		m_activeLayer = activeLayer;
 	}
 	refreshCurveLayerProperties();
+	markSimulatedSetChanged();
 }
 
 int Scene::addLayer(const std::string& name, const glm::vec3& color, bool visible) {
@@ -148,6 +151,8 @@ bool Scene::deleteLayer(int layerId) {
 
 	refreshCurveLayerProperties();
 	m_guides.deselectAll();
+	// Layer ids shifted, so curves now pick up a different layer's simulate flag.
+	markSimulatedSetChanged();
 	clearMirrorPairs();
 	m_hoverCurve = -1;
 	m_hoverHighlightActive = false;
@@ -193,6 +198,20 @@ bool Scene::isLayerVisible(int layerId) const {
 	return m_layers[(size_t)layerId].visible;
 }
 
+void Scene::setLayerSimulated(int layerId, bool simulate) {
+	if (layerId < 0 || layerId >= (int)m_layers.size()) return;
+	if (m_layers[(size_t)layerId].simulate == simulate) return;
+	m_layers[(size_t)layerId].simulate = simulate;
+	markSimulatedSetChanged();
+}
+
+bool Scene::isCurveSimulated(size_t curveIdx) const {
+	if (!m_guideSettings.simulateAll) return m_guides.isCurveSelected(curveIdx);
+	if (curveIdx >= m_guides.curveCount()) return false;
+	const int layerId = m_guides.curve(curveIdx).layerId;
+	return layerId >= 0 && layerId < (int)m_layers.size() && m_layers[(size_t)layerId].simulate;
+}
+
 static glm::vec3 hsvToRgb(float h, float s, float v) {
 	float r = v, g = v, b = v;
 	if (s > 0.0f) {
@@ -265,14 +284,20 @@ void Scene::resetSettingsToDefaults() {
 	m_guideSettings.solverIterations = 24;
 
 	m_renderSettings = RenderSettings();
+	// simulateAll may have changed; the simulation thread only re-snapshots on a guide revision.
+	markSimulatedSetChanged();
 }
 
 bool Scene::loadMeshFromObj(const std::string& path) {
-	m_mesh = std::make_unique<Mesh>();
+	HT_TRACE_SCOPE("Scene::loadMeshFromObj");
+	m_mesh = std::make_shared<Mesh>();
+	m_meshBvh.reset();
 	if (!m_mesh->loadFromObj(path)) {
 		m_mesh.reset();
 		return false;
 	}
+	m_meshBvh = std::make_shared<Bvh>();
+	m_meshBvh->build(*m_mesh);
 	m_meshPath = path;
 	m_meshTexturePath.clear();
 	clearMirrorPairs();
@@ -325,29 +350,26 @@ void Scene::tick() {
 	}
 }
 
-void Scene::simulate(float dt) {
-	if (!m_guideSettings.enableSimulation) return;
-
-	// Fixed timestep accumulator (spiderweb-style). This makes the solver behavior
-	// stable under variable frame rate and avoids energy injection from large dt spikes.
-	static float accumulator = 0.0f;
-	const float fixedDt = 1.0f / 120.0f;
-	const float maxFrameDt = 1.0f / 15.0f; // clamp huge hitches
-	const float clampedDt = glm::clamp(dt, 0.0f, maxFrameDt);
-	accumulator += clampedDt;
+void Scene::simulate(float frameDt) {
+	if (!m_guideSettings.enableSimulation) {
+		m_scheduler.reset();
+		return;
+	}
 
-	// Prevent spiral-of-death if the app stalls.
-	const int maxStepsPerFrame = 8;
-	int steps = 0;
-	while (accumulator >= fixedDt && steps < maxStepsPerFrame) {
+	// Fixed timestep (spiderweb-style): stable under variable frame rate and no energy injection from
+	// large dt spikes. The scheduler decides how many steps fit this frame.
+	const int steps = m_scheduler.beginFrame(frameDt, m_guideSettings);
+	const uint64_t t0 = Trace::nowNs();
+	Physics::StepStats stats;
+	for (int i = 0; i < steps; i++) {
 		if (m_guideSettings.enableGpuSolver && GpuSolver::isAvailable()) {
-			GpuSolver::step(*this, fixedDt);
+			GpuSolver::step(*this, m_scheduler.fixedDt());
 		} else {
-			Physics::step(*this, fixedDt);
+			// Residual error is only measured after the last step of the frame.
+			Physics::step(*this, m_scheduler.fixedDt(), m_scheduler.iterations(), (i + 1 == steps) ? &stats : nullptr);
 		}
-		accumulator -= fixedDt;
-		steps++;
 	}
+	m_scheduler.endFrame(steps, (double)(Trace::nowNs() - t0) * 1e-6, stats);
 }
 
 static bool intersectRayPlane(const glm::vec3& ro, const glm::vec3& rd, const glm::vec3& p0, const glm::vec3& n, float& t) {
@@ -426,7 +448,10 @@ void Scene::handleViewportMouse(const MayaCameraController& camera, int viewport
 		glm::vec3 ro, rd;
 		camera.rayFromPixel(px, py, ro, rd);
 		RayHit hit;
-		if (!Raycast::raycastMesh(*m_mesh, ro, rd, hit)) return;
+		{
+			HT_PROFILE_SCOPE(Picking);
+			if (!Raycast::raycastMesh(*m_mesh, ro, rd, hit)) return;
+		}
 
 		// Prevent duplicate roots (debounce double-clicks / overlapping curves)
 		const float dupRootTol = std::max(0.0005f, m_guideSettings.collisionThickness * 0.5f);
@@ -467,6 +492,7 @@ void Scene::handleViewportMouse(const MayaCameraController& camera, int viewport
 							dst.prevPoints[i] = p;
 						}
 						dst.segmentRestLen = src.segmentRestLen;
+						HairGuideSet::captureRestShape(dst, *m_mesh);
 						setMirrorPair(newIdx, mirrorIdx);
 
 						// Select both, but keep the clicked curve as active.
@@ -571,6 +597,14 @@ void Scene::updateDragVertex(const MayaCameraController& camera, int viewportW,
 	}
 }
 
+int Scene::dragMirrorCurve() const {
+	if (!m_dragging || !m_guideSettings.mirrorMode) return -1;
+	int peer = mirrorPeerOf(m_dragCurve);
+	if (peer < 0) return -1;
+	if (!m_guides.isCurveSelected((size_t)peer) || !m_guides.isCurveSelected((size_t)m_dragCurve)) return -1;
+	return peer;
+}
+
 void Scene::endDragVertex() {
 	m_dragging = false;
 	m_dragCurve = -1;
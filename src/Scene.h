@@ -2,7 +2,9 @@
 
 #include "HairGuides.h"
 #include "Mesh.h"
+#include "Bvh.h"
 #include "MeshDistanceField.h"
+#include "SimScheduler.h"
 
 #include <memory>
 #include <string>
@@ -24,6 +26,7 @@ struct LayerInfo {
 	std::string name;
 	glm::vec3 color{0.90f, 0.75f, 0.22f};
 	bool visible = true;
+	bool simulate = true;               // included in GuideSettings::simulateAll
 };
 
 class Scene {
@@ -36,6 +39,11 @@ public:
 	void setMeshTexturePath(const std::string& path) { m_meshTexturePath = path; }
 	const Mesh* mesh() const { return m_mesh.get(); }
 	Mesh* mesh() { return m_mesh.get(); }
+	// Collision BVH, built when the mesh is loaded.
+	const Bvh* meshBvh() const { return m_meshBvh.get(); }
+	// Shared ownership lets the simulation thread keep using a mesh the UI has already replaced.
+	std::shared_ptr<const Mesh> sharedMesh() const { return m_mesh; }
+	std::shared_ptr<const Bvh> sharedMeshBvh() const { return m_meshBvh; }
 
 	const glm::vec3& meshBoundsMin() const { return m_meshBoundsMin; }
 	const glm::vec3& meshBoundsMax() const { return m_meshBoundsMax; }
@@ -62,11 +70,18 @@ public:
 	void setActiveLayer(int layerId);
 	void setLayerVisible(int layerId, bool visible);
 	void setLayerColor(int layerId, const glm::vec3& color);
+	void setLayerSimulated(int layerId, bool simulate);
 	bool isLayerVisible(int layerId) const;
 	glm::vec3 generateDistinctLayerColor();
 
 	void tick();
-	void simulate(float dt);
+	// Advances the solver by frameDt seconds of real time in fixed steps (see SimScheduler).
+	void simulate(float frameDt);
+	const SimScheduler& scheduler() const { return m_scheduler; }
+	// Whether the solver steps this curve: the selection, or with simulateAll every curve on a simulated layer.
+	bool isCurveSimulated(size_t curveIdx) const;
+	// Call after changing what isCurveSimulated returns outside of the guide set (scope, layer flags).
+	void markSimulatedSetChanged() { m_guides.markChanged(); }
 
 	void handleViewportMouse(const MayaCameraController& camera, int viewportW, int viewportH);
 	void deleteSelectedCurves();
@@ -85,9 +100,12 @@ public:
 	bool isDragging() const { return m_dragging; }
 	int dragCurve() const { return m_dragCurve; }
 	int dragVert() const { return m_dragVert; }
+	// Mirror peer that follows the dragged vertex, or -1.
+	int dragMirrorCurve() const;
 
 private:
-	std::unique_ptr<Mesh> m_mesh;
+	std::shared_ptr<Mesh> m_mesh;
+	std::shared_ptr<Bvh> m_meshBvh;
 	std::string m_meshPath;
 	std::string m_meshTexturePath;
 	glm::vec3 m_meshBoundsMin{0.0f};
@@ -98,6 +116,7 @@ private:
 	HairGuideSet m_guides;
 	GuideSettings m_guideSettings;
 	RenderSettings m_renderSettings;
+	SimScheduler m_scheduler;
 
 	std::vector<LayerInfo> m_layers;
 	int m_activeLayer = 0;
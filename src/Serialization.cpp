@@ -3,10 +3,25 @@
 #include "Scene.h"
 #include "Mesh.h"
 #include "Camera.h"
+#include "Log.h"
+#include "MappedFile.h"
+#include "Trace.h"
 
 #include <json/json.h>
+#include <zlib.h>
 
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <memory>
+#include <string_view>
+#include <vector>
 
 static Json::Value vec3ToJson(const glm::vec3& v) {
 	Json::Value a(Json::arrayValue);
@@ -21,7 +36,9 @@ static glm::vec3 jsonToVec3(const Json::Value& a) {
 	return glm::vec3(a[0].asFloat(), a[1].asFloat(), a[2].asFloat());
 }
 
-bool Serialization::saveScene(const Scene& scene, const Camera& camera, const std::string& path) {
+// Everything but the curves: mesh, camera, guide settings and layers. Both formats store this as JSON;
+// in binary scenes it is the META chunk, so settings can be added without changing the binary layout.
+static Json::Value sceneToJson(const Scene& scene, const Camera& camera) {
 	Json::Value root;
 	root["version"] = 2;
 	root["meshPath"] = scene.meshPath();
@@ -45,13 +62,26 @@ bool Serialization::saveScene(const Scene& scene, const Camera& camera, const st
 	jgs["enableSimulation"] = gs.enableSimulation;
 	jgs["enableMeshCollision"] = gs.enableMeshCollision;
 	jgs["enableCurveCollision"] = gs.enableCurveCollision;
+	jgs["continuousCollision"] = gs.continuousCollision;
 	jgs["enableGpuSolver"] = gs.enableGpuSolver;
+	jgs["simulationThread"] = gs.simulationThread;
+	jgs["simulateAll"] = gs.simulateAll;
 	jgs["collisionThickness"] = gs.collisionThickness;
 	jgs["collisionFriction"] = gs.collisionFriction;
 	jgs["solverIterations"] = gs.solverIterations;
+	jgs["solverBudgetMs"] = gs.solverBudgetMs;
+	jgs["adaptiveSolver"] = gs.adaptiveSolver;
+	jgs["enableSleeping"] = gs.enableSleeping;
+	jgs["sleepThreshold"] = gs.sleepThreshold;
 	jgs["gravity"] = gs.gravity;
 	jgs["damping"] = gs.damping;
 	jgs["stiffness"] = gs.stiffness;
+	jgs["directStretchSolve"] = gs.directStretchSolve;
+	jgs["rodBending"] = gs.rodBending;
+	jgs["shapeStiffness"] = gs.shapeStiffness;
+	jgs["shapeHold"] = gs.shapeHold;
+	jgs["useXpbd"] = gs.useXpbd;
+	jgs["bendCompliance"] = gs.bendCompliance;
 	jgs["dragLerp"] = gs.dragLerp;
 	root["guideSettings"] = jgs;
 
@@ -63,62 +93,27 @@ bool Serialization::saveScene(const Scene& scene, const Camera& camera, const st
 		jl["name"] = layer.name;
 		jl["color"] = vec3ToJson(layer.color);
 		jl["visible"] = layer.visible;
+		jl["simulate"] = layer.simulate;
 		layers.append(jl);
 	}
 	root["layers"] = layers;
 	root["activeLayer"] = scene.activeLayer();
-
-	Json::Value curves(Json::arrayValue);
-	for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) {
-		const HairCurve& c = scene.guides().curve(ci);
-		Json::Value jc;
-		jc["rootTri"] = c.root.triIndex;
-		jc["rootBary"] = vec3ToJson(c.root.bary);
-		jc["layer"] = c.layerId;
-
-		Json::Value pts(Json::arrayValue);
-		for (const glm::vec3& p : c.points) pts.append(vec3ToJson(p));
-		jc["points"] = pts;
-
-		curves.append(jc);
-	}
-	root["curves"] = curves;
-
-	Json::StreamWriterBuilder wb;
-	wb["indentation"] = "  ";
-	std::unique_ptr<Json::StreamWriter> writer(wb.newStreamWriter());
-
-	std::ofstream f(path, std::ios::binary);
-	if (!f.is_open()) return false;
-	writer->write(root, &f);
-	return true;
+	return root;
 }
-bool Serialization::loadScene(Scene& scene, Camera* camera, const std::string& path, bool* outCameraRestored) {
-	std::ifstream f(path, std::ios::binary);
-	if (!f.is_open()) return false;
-
-	Json::CharReaderBuilder rb;
-	Json::Value root;
-	std::string errs;
-	if (!Json::parseFromStream(rb, f, &root, &errs)) {
-		return false;
-	}
 
+// Loads the mesh and applies what sceneToJson wrote. Returns false if there is no mesh, in which case
+// the curve roots can't be restored and the caller keeps the scene empty.
+static bool applySceneJson(Scene& scene, Camera* camera, const Json::Value& root, bool& outCameraRestored) {
+	outCameraRestored = false;
 	std::string meshPath = root.get("meshPath", "").asString();
 	std::string meshTexturePath = root.get("meshTexturePath", "").asString();
 	if (!meshPath.empty()) {
 		scene.loadMeshFromObj(meshPath);
 	}
-	if (!scene.mesh()) {
-		// Can't restore curve roots without the mesh; keep the scene empty.
-		scene.guides().clear();
-		if (outCameraRestored) *outCameraRestored = false;
-		return true;
-	}
+	if (!scene.mesh()) return false;
 
 	scene.setMeshTexturePath(meshTexturePath);
 
-	bool cameraRestored = false;
 	if (camera) {
 		Json::Value jc = root["camera"];
 		if (jc.isObject()) {
@@ -127,7 +122,7 @@ bool Serialization::loadScene(Scene& scene, Camera* camera, const std::string& p
 			float pitch = jc.get("pitch", camera->pitch()).asFloat();
 			float dist = jc.get("distance", camera->distance()).asFloat();
 			camera->setState(target, dist, yaw, pitch);
-			cameraRestored = true;
+			outCameraRestored = true;
 		}
 	}
 
@@ -140,13 +135,26 @@ bool Serialization::loadScene(Scene& scene, Camera* camera, const std::string& p
 		gs.enableSimulation = jgs.get("enableSimulation", gs.enableSimulation).asBool();
 		gs.enableMeshCollision = jgs.get("enableMeshCollision", gs.enableMeshCollision).asBool();
 		gs.enableCurveCollision = jgs.get("enableCurveCollision", gs.enableCurveCollision).asBool();
+		gs.continuousCollision = jgs.get("continuousCollision", gs.continuousCollision).asBool();
 		gs.enableGpuSolver = jgs.get("enableGpuSolver", gs.enableGpuSolver).asBool();
+		gs.simulationThread = jgs.get("simulationThread", gs.simulationThread).asBool();
+		gs.simulateAll = jgs.get("simulateAll", gs.simulateAll).asBool();
 		gs.collisionThickness = jgs.get("collisionThickness", gs.collisionThickness).asFloat();
 		gs.collisionFriction = jgs.get("collisionFriction", gs.collisionFriction).asFloat();
 		gs.solverIterations = jgs.get("solverIterations", gs.solverIterations).asInt();
+		gs.solverBudgetMs = jgs.get("solverBudgetMs", gs.solverBudgetMs).asFloat();
+		gs.adaptiveSolver = jgs.get("adaptiveSolver", gs.adaptiveSolver).asBool();
+		gs.enableSleeping = jgs.get("enableSleeping", gs.enableSleeping).asBool();
+		gs.sleepThreshold = jgs.get("sleepThreshold", gs.sleepThreshold).asFloat();
 		gs.gravity = jgs.get("gravity", gs.gravity).asFloat();
 		gs.damping = jgs.get("damping", gs.damping).asFloat();
 		gs.stiffness = jgs.get("stiffness", gs.stiffness).asFloat();
+		gs.directStretchSolve = jgs.get("directStretchSolve", gs.directStretchSolve).asBool();
+		gs.rodBending = jgs.get("rodBending", gs.rodBending).asBool();
+		gs.shapeStiffness = jgs.get("shapeStiffness", gs.shapeStiffness).asFloat();
+		gs.shapeHold = jgs.get("shapeHold", gs.shapeHold).asFloat();
+		gs.useXpbd = jgs.get("useXpbd", gs.useXpbd).asBool();
+		gs.bendCompliance = jgs.get("bendCompliance", gs.bendCompliance).asFloat();
 		gs.dragLerp = jgs.get("dragLerp", gs.dragLerp).asFloat();
 	}
 
@@ -163,6 +171,7 @@ bool Serialization::loadScene(Scene& scene, Camera* camera, const std::string& p
 				l.color = glm::vec3(0.90f, 0.75f, 0.22f);
 			}
 			l.visible = jl.get("visible", true).asBool();
+			l.simulate = jl.get("simulate", true).asBool();
 			layers.push_back(l);
 		}
 	}
@@ -179,46 +188,826 @@ bool Serialization::loadScene(Scene& scene, Camera* camera, const std::string& p
 		fallback.push_back(base);
 		scene.setLayers(fallback, 0);
 	}
+	return true;
+}
+
+// Fills the fields a loaded curve doesn't store: layer (clamped to the scene's layers), its color and
+// visibility, and the rest length as the mean segment length.
+static void finishLoadedCurve(const Scene& scene, HairCurve& c) {
+	if (c.layerId < 0 || c.layerId >= (int)scene.layerCount()) c.layerId = 0;
+	const LayerInfo& layer = scene.layer((size_t)c.layerId);
+	c.color = layer.color;
+	c.visible = layer.visible;
+	if (c.points.size() >= 2) {
+		float sum = 0.0f;
+		for (size_t si = 0; si + 1 < c.points.size(); si++) sum += glm::length(c.points[si + 1] - c.points[si]);
+		c.segmentRestLen = sum / (float)(c.points.size() - 1);
+	}
+}
+
+// Streaming JSON for the curves. A Json::Value per coordinate costs many times the memory of the
+// curves themselves, so the writer formats curves straight into an output buffer and the reader parses
+// them straight into HairCurves. The small scene-level members still go through JsonCpp.
+
+// Shortest text that reads back to the same float. Non-finite values are written as null, which reads
+// back as 0 like JsonCpp's asFloat().
+static void putJsonFloat(std::string& out, float v) {
+	if (!std::isfinite(v)) {
+		out += "null";
+		return;
+	}
+	char b[32];
+	const std::to_chars_result r = std::to_chars(b, b + sizeof(b), v);
+	out.append(b, r.ptr);
+}
+
+static void putJsonInt(std::string& out, int v) {
+	char b[16];
+	const std::to_chars_result r = std::to_chars(b, b + sizeof(b), v);
+	out.append(b, r.ptr);
+}
+
+static void putJsonVec3(std::string& out, const glm::vec3& v) {
+	out += '[';
+	putJsonFloat(out, v.x);
+	out += ',';
+	putJsonFloat(out, v.y);
+	out += ',';
+	putJsonFloat(out, v.z);
+	out += ']';
+}
+
+static void putJsonVec3Array(std::string& out, const std::vector<glm::vec3>& a) {
+	out += '[';
+	for (size_t i = 0; i < a.size(); i++) {
+		if (i > 0) out += ',';
+		putJsonVec3(out, a[i]);
+	}
+	out += ']';
+}
+
+namespace {
+	// Pull parser over a JSON document in memory with just what the scene schema needs: curves are
+	// read value by value, everything else is skipped over and returned as a text span. Like JsonCpp's
+	// defaults, comments are allowed and text after the root value is ignored.
+	class JsonCursor {
+	public:
+		JsonCursor(const char* begin, const char* end) : m_begin(begin), m_p(begin), m_end(end) {}
+
+		bool failed() const { return m_failed; }
+		size_t offset() const { return (size_t)(m_p - m_begin); }
+
+		// Consumes c if it is the next character after whitespace.
+		bool consume(char c) {
+			skipSpace();
+			if (m_p < m_end && *m_p == c) {
+				m_p++;
+				return true;
+			}
+			return false;
+		}
+
+		bool peek(char c) {
+			skipSpace();
+			return m_p < m_end && *m_p == c;
+		}
+
+		void expect(char c) {
+			if (!consume(c)) fail();
+		}
+
+		// Raw string contents; escapes are skipped over but not decoded (only used for keys).
+		std::string_view readString() {
+			skipSpace();
+			if (m_p >= m_end || *m_p != '"') {
+				fail();
+				return {};
+			}
+			const char* start = ++m_p;
+			while (m_p < m_end && *m_p != '"') m_p += (*m_p == '\\') ? 2 : 1;
+			if (m_p >= m_end) {
+				fail();
+				return {};
+			}
+			return std::string_view(start, (size_t)(m_p++ - start));
+		}
+
+		// null reads as 0 like JsonCpp's asFloat(); other non-numbers are skipped and leave v unchanged.
+		void readFloat(float& v) {
+			skipSpace();
+			if (m_p < m_end && (*m_p == '-' || (*m_p >= '0' && *m_p <= '9'))) {
+				const std::from_chars_result r = std::from_chars(m_p, m_end, v);
+				if (r.ec == std::errc::invalid_argument) {
+					fail();
+					return;
+				}
+				if (r.ec == std::errc::result_out_of_range) {
+					// Outside float range: as JsonCpp does, accept anything a double holds.
+					double d = 0.0;
+					if (std::from_chars(m_p, m_end, d).ec != std::errc()) {
+						fail();
+						return;
+					}
+					v = (float)d;
+				}
+				m_p = r.ptr;
+			} else if (literal("null")) {
+				v = 0.0f;
+			} else {
+				skipValue();
+			}
+		}
+
+		void readInt(int& v) {
+			skipSpace();
+			if (m_p < m_end && (*m_p == '-' || (*m_p >= '0' && *m_p <= '9'))) {
+				double d = 0.0;
+				const std::from_chars_result r = std::from_chars(m_p, m_end, d);
+				if (r.ec != std::errc()) {
+					fail();
+					return;
+				}
+				v = (int)std::clamp(d, -2147483648.0, 2147483647.0);
+				m_p = r.ptr;
+			} else if (literal("null")) {
+				v = 0;
+			} else {
+				skipValue();
+			}
+		}
+
+		// [x, y, z]; anything else reads as 0 like jsonToVec3().
+		glm::vec3 readVec3() {
+			if (!consume('[')) {
+				skipValue();
+				return glm::vec3(0.0f);
+			}
+			float v[3] = {0.0f, 0.0f, 0.0f};
+			int count = 0;
+			if (!consume(']')) {
+				do {
+					float f = 0.0f;
+					readFloat(f);
+					if (count < 3) v[count] = f;
+					count++;
+				} while (!m_failed && consume(','));
+				expect(']');
+			}
+			return (count == 3) ? glm::vec3(v[0], v[1], v[2]) : glm::vec3(0.0f);
+		}
+
+		// An array of vec3; anything else reads as empty.
+		void readVec3Array(std::vector<glm::vec3>& out) {
+			out.clear();
+			if (!consume('[')) {
+				skipValue();
+				return;
+			}
+			if (consume(']')) return;
+			do {
+				out.push_back(readVec3());
+			} while (!m_failed && consume(','));
+			expect(']');
+		}
+
+		// Skips one value of any type and returns its text.
+		std::string_view skipValue() {
+			skipSpace();
+			const char* start = m_p;
+			if (m_p >= m_end) {
+				fail();
+				return {};
+			}
+			if (*m_p == '"') {
+				readString();
+			} else if (*m_p == '{' || *m_p == '[') {
+				int depth = 0;
+				while (m_p < m_end) {
+					const char c = *m_p;
+					if (c == '"') {
+						readString();
+						if (m_failed) return {};
+						continue;
+					}
+					m_p++;
+					if (c == '{' || c == '[') {
+						depth++;
+					} else if ((c == '}' || c == ']') && --depth == 0) {
+						break;
+					}
+				}
+				if (depth != 0) fail();
+			} else {
+				// Number or literal: up to the next delimiter.
+				while (m_p < m_end && !std::isspace((unsigned char)*m_p) && *m_p != ',' && *m_p != ']' && *m_p != '}') m_p++;
+				if (m_p == start) fail();
+			}
+			return std::string_view(start, (size_t)(m_p - start));
+		}
+
+	private:
+		void fail() {
+			m_failed = true;
+			m_p = m_end;
+		}
+
+		bool literal(const char* word) {
+			const size_t n = std::strlen(word);
+			if ((size_t)(m_end - m_p) < n || std::memcmp(m_p, word, n) != 0) return false;
+			m_p += n;
+			return true;
+		}
+
+		void skipSpace() {
+			while (m_p < m_end) {
+				if (std::isspace((unsigned char)*m_p)) {
+					m_p++;
+				} else if (*m_p == '/' && m_end - m_p >= 2 && m_p[1] == '/') {
+					while (m_p < m_end && *m_p != '\n') m_p++;
+				} else if (*m_p == '/' && m_end - m_p >= 2 && m_p[1] == '*') {
+					const char* close = m_p + 2;
+					while (close + 1 < m_end && !(close[0] == '*' && close[1] == '/')) close++;
+					m_p = (close + 1 < m_end) ? close + 2 : m_end;
+				} else {
+					break;
+				}
+			}
+		}
+
+		const char* m_begin;
+		const char* m_p;
+		const char* m_end;
+		bool m_failed = false;
+	};
+}
+
+static void readJsonCurves(JsonCursor& in, std::vector<HairCurve>& out) {
+	in.expect('[');
+	if (in.consume(']')) return;
+	do {
+		HairCurve& c = out.emplace_back();
+		if (!in.consume('{')) {
+			in.skipValue();
+			continue;
+		}
+		if (in.consume('}')) continue;
+		do {
+			const std::string_view key = in.readString();
+			in.expect(':');
+			if (key == "rootTri") in.readInt(c.root.triIndex);
+			else if (key == "rootBary") c.root.bary = in.readVec3();
+			else if (key == "layer") in.readInt(c.layerId);
+			else if (key == "points") in.readVec3Array(c.points);
+			else if (key == "restShape") in.readVec3Array(c.restLocal);
+			else in.skipValue();
+		} while (!in.failed() && in.consume(','));
+		in.expect('}');
+	} while (!in.failed() && in.consume(','));
+	in.expect(']');
+}
+
+// Reads the curves into outCurves as they are parsed and every other member of the root object into
+// outRoot through JsonCpp, so applySceneJson() sees the same values as with the DOM reader.
+static bool parseSceneJson(const char* begin, const char* end, Json::Value& outRoot, std::vector<HairCurve>& outCurves) {
+	Json::CharReaderBuilder rb;
+	std::unique_ptr<Json::CharReader> reader(rb.newCharReader());
+	JsonCursor in(begin, end);
+	outRoot = Json::Value(Json::objectValue);
+	in.expect('{');
+	if (!in.failed() && !in.consume('}')) {
+		do {
+			const std::string_view key = in.readString();
+			in.expect(':');
+			if (in.failed()) break;
+			if (key == "curves" && in.peek('[')) {
+				outCurves.clear();
+				readJsonCurves(in, outCurves);
+				continue;
+			}
+			const std::string_view text = in.skipValue();
+			Json::Value value;
+			std::string errs;
+			if (in.failed() || !reader->parse(text.data(), text.data() + text.size(), &value, &errs)) {
+				HT_ERR("ERROR: Scene JSON member \"%.*s\" is invalid: %s\n", (int)key.size(), key.data(), errs.c_str());
+				return false;
+			}
+			outRoot[std::string(key)] = value;
+		} while (!in.failed() && in.consume(','));
+		in.expect('}');
+	}
+	if (in.failed()) {
+		HT_ERR("ERROR: Scene JSON is invalid near offset %zu\n", in.offset());
+		return false;
+	}
+	return true;
+}
+
+// Binary scene layout (little-endian):
+//   "HTSCENE\0", uint32 version
+//   chunks: uint32 id, uint32 flags, uint64 stored bytes, uint64 raw bytes, payload
+//   META  sceneToJson() as compact JSON text
+//   CURV  one CurveRecord per curve
+//   PNTS  every curve's points, float x y z, in curve order
+//   REST  restLocal of the curves with hasRest set, same layout as PNTS
+//   END   empty; marks a complete file
+// Readers skip chunks they don't know, so new chunks don't need a version bump.
+namespace {
+	const char kBinaryMagic[8] = {'H', 'T', 'S', 'C', 'E', 'N', 'E', '\0'};
+	const uint32_t kBinaryVersion = 1;
+
+	constexpr uint32_t chunkId(const char (&s)[5]) {
+		return (uint32_t)(uint8_t)s[0] | ((uint32_t)(uint8_t)s[1] << 8) | ((uint32_t)(uint8_t)s[2] << 16) | ((uint32_t)(uint8_t)s[3] << 24);
+	}
+	constexpr uint32_t kChunkMeta = chunkId("META");
+	constexpr uint32_t kChunkCurves = chunkId("CURV");
+	constexpr uint32_t kChunkPoints = chunkId("PNTS");
+	constexpr uint32_t kChunkRest = chunkId("REST");
+	constexpr uint32_t kChunkEnd = chunkId("END ");
+
+	const uint32_t kChunkDeflate = 1u << 0;   // payload is zlib-compressed
+	const uint32_t kChunkShuffled = 1u << 1;  // 4-byte words stored as four byte planes (before deflate)
+	const size_t kChunkHeaderBytes = 24;
+
+	using CurveRecord = Serialization::SceneSnapshot::Curve;
+	static_assert(sizeof(CurveRecord) == 28, "CurveRecord must be packed 4-byte words");
+	static_assert(sizeof(glm::vec3) == 12, "points are written as packed float triples");
+
+	// A decoded chunk payload: a view into the mapping, or owned storage if it had to be inflated.
+	struct Chunk {
+		const char* data = nullptr;
+		size_t size = 0;
+		bool present = false;
+		std::vector<char> owned;
+	};
+}
+
+static void putU32(std::vector<char>& out, uint32_t v) {
+	for (int i = 0; i < 4; i++) out.push_back((char)(uint8_t)(v >> (8 * i)));
+}
+
+static void putU64(std::vector<char>& out, uint64_t v) {
+	for (int i = 0; i < 8; i++) out.push_back((char)(uint8_t)(v >> (8 * i)));
+}
+
+static uint32_t getU32(const char* p) {
+	uint32_t v = 0;
+	for (int i = 0; i < 4; i++) v |= (uint32_t)(uint8_t)p[i] << (8 * i);
+	return v;
+}
+
+static uint64_t getU64(const char* p) {
+	uint64_t v = 0;
+	for (int i = 0; i < 8; i++) v |= (uint64_t)(uint8_t)p[i] << (8 * i);
+	return v;
+}
+
+// All payloads but META are 4-byte words; big-endian hosts swap them on the way in and out.
+static void wordsToLittleEndian(char* data, size_t bytes) {
+	if constexpr (std::endian::native == std::endian::little) return;
+	for (size_t i = 0; i + 4 <= bytes; i += 4) std::reverse(data + i, data + i + 4);
+}
+
+// Byte-plane transpose of 4-byte words. Neighbouring points share their float exponents and high
+// mantissa bytes, so deflate finds far more matches in the planes than in the interleaved words.
+static void shuffleWords(const char* src, char* dst, size_t words) {
+	for (size_t w = 0; w < words; w++) {
+		for (size_t b = 0; b < 4; b++) dst[b * words + w] = src[w * 4 + b];
+	}
+}
+
+static void unshuffleWords(const char* src, char* dst, size_t words) {
+	for (size_t w = 0; w < words; w++) {
+		for (size_t b = 0; b < 4; b++) dst[w * 4 + b] = src[b * words + w];
+	}
+}
+
+// Writes one chunk. Word chunks are shuffled before deflating; the compressed form is kept only if it
+// is smaller.
+static void writeChunk(std::ofstream& f, uint32_t id, const char* data, size_t bytes, bool words, bool compress) {
+	std::vector<char> native;
+	if (words && std::endian::native != std::endian::little) {
+		native.assign(data, data + bytes);
+		wordsToLittleEndian(native.data(), bytes);
+		data = native.data();
+	}
+
+	uint32_t flags = 0;
+	std::vector<char> stored;
+	// zlib's sizes are uLong, which is 32-bit on Windows.
+	if (compress && bytes > 0 && bytes <= 0xffffffffu) {
+		const char* src = data;
+		std::vector<char> shuffled;
+		if (words) {
+			shuffled.resize(bytes);
+			shuffleWords(data, shuffled.data(), bytes / 4);
+			src = shuffled.data();
+		}
+		uLongf len = compressBound((uLong)bytes);
+		stored.resize((size_t)len);
+		if (compress2((Bytef*)stored.data(), &len, (const Bytef*)src, (uLong)bytes, Z_BEST_SPEED) == Z_OK && (size_t)len < bytes) {
+			stored.resize((size_t)len);
+			flags = kChunkDeflate | (words ? kChunkShuffled : 0u);
+		} else {
+			stored.clear();
+		}
+	}
+
+	std::vector<char> header;
+	header.reserve(kChunkHeaderBytes);
+	putU32(header, id);
+	putU32(header, flags);
+	putU64(header, flags ? stored.size() : bytes);
+	putU64(header, bytes);
+	f.write(header.data(), (std::streamsize)header.size());
+	if (flags) {
+		f.write(stored.data(), (std::streamsize)stored.size());
+	} else if (bytes > 0) {
+		f.write(data, (std::streamsize)bytes);
+	}
+}
+
+static bool decodeChunk(const char* payload, uint32_t flags, uint64_t storedBytes, uint64_t rawBytes, bool words, Chunk& out) {
+	out.present = true;
+	const bool deflated = (flags & kChunkDeflate) != 0;
+	const bool shuffled = (flags & kChunkShuffled) != 0;
+	if (!deflated && storedBytes != rawBytes) return false;
+	if (shuffled && rawBytes % 4 != 0) return false;
+	const bool swap = words && std::endian::native != std::endian::little;
+	if (!deflated && !shuffled && !swap) {
+		out.data = payload;
+		out.size = (size_t)rawBytes;
+		return true;
+	}
+
+	const char* src = payload;
+	std::vector<char> inflated;
+	if (deflated) {
+		if (rawBytes > 0xffffffffu || storedBytes > 0xffffffffu) return false;
+		std::vector<char>& dst = shuffled ? inflated : out.owned;
+		dst.resize((size_t)rawBytes);
+		uLongf len = (uLongf)rawBytes;
+		if (uncompress((Bytef*)dst.data(), &len, (const Bytef*)payload, (uLong)storedBytes) != Z_OK || len != (uLongf)rawBytes) return false;
+		src = dst.data();
+	}
+	if (shuffled) {
+		out.owned.resize((size_t)rawBytes);
+		unshuffleWords(src, out.owned.data(), (size_t)rawBytes / 4);
+	} else if (!deflated) {
+		out.owned.assign(payload, payload + rawBytes);
+	}
+	if (swap) wordsToLittleEndian(out.owned.data(), out.owned.size());
+	out.data = out.owned.data();
+	out.size = out.owned.size();
+	return true;
+}
+
+bool Serialization::isBinaryScenePath(const std::string& path) {
+	std::string ext = std::filesystem::path(path).extension().string();
+	std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+	return ext == ".hts";
+}
+
+bool Serialization::saveScene(const Scene& scene, const Camera& camera, const std::string& path) {
+	if (isBinaryScenePath(path)) return saveSceneBinary(scene, camera, path);
+	return saveSceneJson(scene, camera, path);
+}
+
+bool Serialization::saveSceneJson(const Scene& scene, const Camera& camera, const std::string& path) {
+	HT_TRACE_SCOPE("Serialization::saveSceneJson");
+	Json::StreamWriterBuilder wb;
+	wb["indentation"] = "  ";
+	std::string text = Json::writeString(wb, sceneToJson(scene, camera));
+	// Reopen the root object and append the curves member, one curve per line.
+	const size_t close = text.find_last_of('}');
+	if (close == std::string::npos) return false;
+	text.resize(close);
+	while (!text.empty() && std::isspace((unsigned char)text.back())) text.pop_back();
+	text += ",\n  \"curves\" : [";
+
+	std::ofstream f(path, std::ios::binary);
+	if (!f.is_open()) return false;
+	const size_t flushBytes = 1 << 20;
+	const HairGuideSet& guides = scene.guides();
+	for (size_t ci = 0; ci < guides.curveCount(); ci++) {
+		const HairCurve& c = guides.curve(ci);
+		text += (ci == 0) ? "\n    {" : ",\n    {";
+		text += "\"rootTri\":";
+		putJsonInt(text, c.root.triIndex);
+		text += ",\"rootBary\":";
+		putJsonVec3(text, c.root.bary);
+		text += ",\"layer\":";
+		putJsonInt(text, c.layerId);
+		text += ",\"points\":";
+		putJsonVec3Array(text, c.points);
+		if (c.restLocal.size() == c.points.size()) {
+			text += ",\"restShape\":";
+			putJsonVec3Array(text, c.restLocal);
+		}
+		text += '}';
+		if (text.size() >= flushBytes) {
+			f.write(text.data(), (std::streamsize)text.size());
+			text.clear();
+		}
+	}
+	text += (guides.curveCount() > 0) ? "\n  ]\n}\n" : "]\n}\n";
+	f.write(text.data(), (std::streamsize)text.size());
+	return f.good();
+}
+
+bool Serialization::saveSceneJsonDom(const Scene& scene, const Camera& camera, const std::string& path) {
+	HT_TRACE_SCOPE("Serialization::saveSceneJsonDom");
+	Json::Value root = sceneToJson(scene, camera);
+
+	Json::Value curves(Json::arrayValue);
+	for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) {
+		const HairCurve& c = scene.guides().curve(ci);
+		Json::Value jc;
+		jc["rootTri"] = c.root.triIndex;
+		jc["rootBary"] = vec3ToJson(c.root.bary);
+		jc["layer"] = c.layerId;
+
+		Json::Value pts(Json::arrayValue);
+		for (const glm::vec3& p : c.points) pts.append(vec3ToJson(p));
+		jc["points"] = pts;
+		if (c.restLocal.size() == c.points.size()) {
+			Json::Value rest(Json::arrayValue);
+			for (const glm::vec3& d : c.restLocal) rest.append(vec3ToJson(d));
+			jc["restShape"] = rest;
+		}
+
+		curves.append(jc);
+	}
+	root["curves"] = curves;
+
+	Json::StreamWriterBuilder wb;
+	wb["indentation"] = "  ";
+	std::unique_ptr<Json::StreamWriter> writer(wb.newStreamWriter());
+
+	std::ofstream f(path, std::ios::binary);
+	if (!f.is_open()) return false;
+	writer->write(root, &f);
+	return true;
+}
+
+bool Serialization::saveSceneBinary(const Scene& scene, const Camera& camera, const std::string& path, bool compress) {
+	HT_TRACE_SCOPE("Serialization::saveSceneBinary");
+	SceneSnapshot snapshot;
+	snapshotScene(scene, camera, snapshot);
+	return writeSceneBinary(snapshot, path, compress);
+}
+
+void Serialization::snapshotScene(const Scene& scene, const Camera& camera, SceneSnapshot& out) {
+	HT_TRACE_SCOPE("Serialization::snapshotScene");
+	const HairGuideSet& guides = scene.guides();
+	out.curves.resize(guides.curveCount());
+	size_t pointCount = 0;
+	size_t restCount = 0;
+	for (size_t ci = 0; ci < guides.curveCount(); ci++) {
+		const HairCurve& c = guides.curve(ci);
+		CurveRecord& r = out.curves[ci];
+		r.pointCount = (uint32_t)c.points.size();
+		r.rootTri = c.root.triIndex;
+		r.rootBary[0] = c.root.bary.x;
+		r.rootBary[1] = c.root.bary.y;
+		r.rootBary[2] = c.root.bary.z;
+		r.layer = c.layerId;
+		r.hasRest = (!c.points.empty() && c.restLocal.size() == c.points.size()) ? 1u : 0u;
+		pointCount += c.points.size();
+		if (r.hasRest) restCount += c.points.size();
+	}
+	// clear() keeps the capacity, so a reused snapshot stops allocating once it has seen the scene.
+	out.points.clear();
+	out.rest.clear();
+	out.points.reserve(pointCount);
+	out.rest.reserve(restCount);
+	for (size_t ci = 0; ci < guides.curveCount(); ci++) {
+		const HairCurve& c = guides.curve(ci);
+		out.points.insert(out.points.end(), c.points.begin(), c.points.end());
+		if (out.curves[ci].hasRest) out.rest.insert(out.rest.end(), c.restLocal.begin(), c.restLocal.end());
+	}
 
+	Json::StreamWriterBuilder wb;
+	wb["indentation"] = "";
+	out.meta = Json::writeString(wb, sceneToJson(scene, camera));
+}
+
+// Mixes 8 bytes at a time (multiply + xor-shift); not cryptographic, just fast and well spread.
+static uint64_t hashBytes(uint64_t h, const void* data, size_t bytes) {
+	const char* p = (const char*)data;
+	auto mix = [&](uint64_t w) {
+		h ^= w;
+		h *= 0x9e3779b97f4a7c15ull;
+		h ^= h >> 32;
+	};
+	size_t i = 0;
+	for (; i + 8 <= bytes; i += 8) {
+		uint64_t w;
+		std::memcpy(&w, p + i, 8);
+		mix(w);
+	}
+	uint64_t tail = 0;
+	if (i < bytes) std::memcpy(&tail, p + i, bytes - i);
+	mix(tail ^ ((uint64_t)bytes << 56));
+	return h;
+}
+
+uint64_t Serialization::SceneSnapshot::hash() const {
+	uint64_t h = 0xcbf29ce484222325ull;
+	h = hashBytes(h, meta.data(), meta.size());
+	h = hashBytes(h, curves.data(), curves.size() * sizeof(Curve));
+	h = hashBytes(h, points.data(), points.size() * sizeof(glm::vec3));
+	h = hashBytes(h, rest.data(), rest.size() * sizeof(glm::vec3));
+	return h;
+}
+
+bool Serialization::writeSceneBinary(const SceneSnapshot& snapshot, const std::string& path, bool compress) {
+	HT_TRACE_SCOPE("Serialization::writeSceneBinary");
+	std::ofstream f(path, std::ios::binary);
+	if (!f.is_open()) return false;
+	std::vector<char> header(kBinaryMagic, kBinaryMagic + sizeof(kBinaryMagic));
+	putU32(header, kBinaryVersion);
+	f.write(header.data(), (std::streamsize)header.size());
+	writeChunk(f, kChunkMeta, snapshot.meta.data(), snapshot.meta.size(), false, compress);
+	writeChunk(f, kChunkCurves, (const char*)snapshot.curves.data(), snapshot.curves.size() * sizeof(CurveRecord), true, compress);
+	writeChunk(f, kChunkPoints, (const char*)snapshot.points.data(), snapshot.points.size() * sizeof(glm::vec3), true, compress);
+	writeChunk(f, kChunkRest, (const char*)snapshot.rest.data(), snapshot.rest.size() * sizeof(glm::vec3), true, compress);
+	writeChunk(f, kChunkEnd, nullptr, 0, false, false);
+	return f.good();
+}
+
+static bool loadSceneJsonDom(Scene& scene, Camera* camera, const MappedFile& file, bool* outCameraRestored) {
+	Json::CharReaderBuilder rb;
+	std::unique_ptr<Json::CharReader> reader(rb.newCharReader());
+	Json::Value root;
+	std::string errs;
+	if (!file.data() || !reader->parse(file.data(), file.data() + file.size(), &root, &errs)) {
+		return false;
+	}
+
+	bool cameraRestored = false;
+	const bool hasMesh = applySceneJson(scene, camera, root, cameraRestored);
 	scene.guides().clear();
+	if (outCameraRestored) *outCameraRestored = cameraRestored;
+	// Can't restore curve roots without the mesh; keep the scene empty.
+	if (!hasMesh) return true;
+
 	Json::Value curves = root["curves"];
 	if (curves.isArray()) {
+		std::vector<HairCurve> loaded(curves.size());
 		for (Json::ArrayIndex i = 0; i < curves.size(); i++) {
 			Json::Value jc = curves[i];
-			HairCurve c;
+			HairCurve& c = loaded[i];
 			c.root.triIndex = jc.get("rootTri", -1).asInt();
 			c.root.bary = jsonToVec3(jc["rootBary"]);
 			c.layerId = jc.get("layer", 0).asInt();
-			if (c.layerId < 0 || c.layerId >= (int)scene.layerCount()) c.layerId = 0;
 
 			Json::Value pts = jc["points"];
 			if (pts.isArray()) {
-				c.points.reserve(pts.size());
-				c.prevPoints.reserve(pts.size());
-				for (Json::ArrayIndex pi = 0; pi < pts.size(); pi++) {
-					glm::vec3 p = jsonToVec3(pts[pi]);
-					c.points.push_back(p);
-					c.prevPoints.push_back(p);
-				}
+				c.points.resize(pts.size());
+				for (Json::ArrayIndex pi = 0; pi < pts.size(); pi++) c.points[pi] = jsonToVec3(pts[pi]);
 			}
-			if (c.points.size() >= 2) {
-				float sum = 0.0f;
-				for (size_t si = 0; si + 1 < c.points.size(); si++) sum += glm::length(c.points[si + 1] - c.points[si]);
-				c.segmentRestLen = sum / (float)(c.points.size() - 1);
+			finishLoadedCurve(scene, c);
+
+			// Older scenes have no rest shape; appendCurves captures the saved shape instead.
+			Json::Value rest = jc["restShape"];
+			if (rest.isArray() && rest.size() == c.points.size()) {
+				c.restLocal.resize(rest.size());
+				for (Json::ArrayIndex ri = 0; ri < rest.size(); ri++) c.restLocal[ri] = jsonToVec3(rest[ri]);
 			}
+		}
+		scene.guides().appendCurves(*scene.mesh(), std::move(loaded));
+	}
+	return true;
+}
+
+static bool loadSceneJson(Scene& scene, Camera* camera, const MappedFile& file, bool* outCameraRestored) {
+	Json::Value root;
+	std::vector<HairCurve> loaded;
+	if (!file.data() || !parseSceneJson(file.data(), file.data() + file.size(), root, loaded)) {
+		return false;
+	}
 
-			// Append via addCurveOnMesh (to preserve internal invariants), then overwrite with loaded data.
-			const LayerInfo& layer = scene.layer((size_t)c.layerId);
-			scene.guides().addCurveOnMesh(*scene.mesh(), c.root.triIndex, c.root.bary,
-				c.points.empty() ? glm::vec3(0) : c.points[0],
-				glm::vec3(0, 1, 0), gs, c.layerId, layer.color, layer.visible);
-			HairCurve& dst = scene.guides().curve(scene.guides().curveCount() - 1);
-			dst = c;
-			dst.color = layer.color;
-			dst.visible = layer.visible;
+	bool cameraRestored = false;
+	const bool hasMesh = applySceneJson(scene, camera, root, cameraRestored);
+	scene.guides().clear();
+	if (outCameraRestored) *outCameraRestored = cameraRestored;
+	// Can't restore curve roots without the mesh; keep the scene empty.
+	if (!hasMesh) return true;
+
+	// Older scenes have no rest shape; appendCurves captures the saved shape instead.
+	for (HairCurve& c : loaded) finishLoadedCurve(scene, c);
+	scene.guides().appendCurves(*scene.mesh(), std::move(loaded));
+	return true;
+}
+
+static bool loadSceneBinary(Scene& scene, Camera* camera, const MappedFile& file, bool* outCameraRestored) {
+	const char* data = file.data();
+	const size_t size = file.size();
+	const size_t headerBytes = sizeof(kBinaryMagic) + 4;
+	if (size < headerBytes) return false;
+	const uint32_t version = getU32(data + sizeof(kBinaryMagic));
+	if (version > kBinaryVersion) {
+		HT_ERR("ERROR: Scene file version %u is newer than this build supports (%u)\n", version, kBinaryVersion);
+		return false;
+	}
+
+	// Decode and check every chunk before touching the scene, so a damaged file leaves it unchanged.
+	Chunk meta, curves, points, rest;
+	bool complete = false;
+	size_t pos = headerBytes;
+	while (pos + kChunkHeaderBytes <= size) {
+		const uint32_t id = getU32(data + pos);
+		const uint32_t flags = getU32(data + pos + 4);
+		const uint64_t storedBytes = getU64(data + pos + 8);
+		const uint64_t rawBytes = getU64(data + pos + 16);
+		pos += kChunkHeaderBytes;
+		if (storedBytes > size - pos) break;
+		if (id == kChunkEnd) {
+			complete = true;
+			break;
 		}
+		Chunk* target = nullptr;
+		if (id == kChunkMeta) target = &meta;
+		else if (id == kChunkCurves) target = &curves;
+		else if (id == kChunkPoints) target = &points;
+		else if (id == kChunkRest) target = &rest;
+		if (target && !decodeChunk(data + pos, flags, storedBytes, rawBytes, id != kChunkMeta, *target)) {
+			HT_ERR("ERROR: Scene file has a corrupt chunk at offset %zu\n", pos - kChunkHeaderBytes);
+			return false;
+		}
+		pos += (size_t)storedBytes;
+	}
+	if (!complete || !meta.present || !curves.present || !points.present || curves.size % sizeof(CurveRecord) != 0) {
+		HT_ERR("ERROR: Scene file is truncated or incomplete\n");
+		return false;
+	}
+
+	const size_t curveCount = curves.size / sizeof(CurveRecord);
+	std::vector<CurveRecord> records(curveCount);
+	if (curveCount > 0) std::memcpy(records.data(), curves.data, curves.size);
+	size_t pointCount = 0;
+	size_t restCount = 0;
+	for (const CurveRecord& r : records) {
+		pointCount += r.pointCount;
+		if (r.hasRest) restCount += r.pointCount;
+	}
+	if (points.size != pointCount * sizeof(glm::vec3) || rest.size != restCount * sizeof(glm::vec3)) {
+		HT_ERR("ERROR: Scene file curve table doesn't match its point data\n");
+		return false;
+	}
+
+	Json::CharReaderBuilder rb;
+	std::unique_ptr<Json::CharReader> reader(rb.newCharReader());
+	Json::Value root;
+	std::string errs;
+	if (!reader->parse(meta.data, meta.data + meta.size, &root, &errs)) {
+		HT_ERR("ERROR: Scene file settings are invalid: %s\n", errs.c_str());
+		return false;
 	}
 
+	bool cameraRestored = false;
+	const bool hasMesh = applySceneJson(scene, camera, root, cameraRestored);
+	scene.guides().clear();
 	if (outCameraRestored) *outCameraRestored = cameraRestored;
+	if (!hasMesh) return true;
+
+	std::vector<HairCurve> loaded(curveCount);
+	const char* pointData = points.data;
+	const char* restData = rest.data;
+	for (size_t ci = 0; ci < curveCount; ci++) {
+		const CurveRecord& r = records[ci];
+		HairCurve& c = loaded[ci];
+		c.root.triIndex = r.rootTri;
+		c.root.bary = glm::vec3(r.rootBary[0], r.rootBary[1], r.rootBary[2]);
+		c.layerId = r.layer;
+		const size_t bytes = (size_t)r.pointCount * sizeof(glm::vec3);
+		c.points.resize(r.pointCount);
+		if (bytes > 0) std::memcpy(c.points.data(), pointData, bytes);
+		pointData += bytes;
+		if (r.hasRest) {
+			c.restLocal.resize(r.pointCount);
+			if (bytes > 0) std::memcpy(c.restLocal.data(), restData, bytes);
+			restData += bytes;
+		}
+		finishLoadedCurve(scene, c);
+	}
+	scene.guides().appendCurves(*scene.mesh(), std::move(loaded));
 	return true;
 }
+
+bool Serialization::loadScene(Scene& scene, Camera* camera, const std::string& path, bool* outCameraRestored) {
+	HT_TRACE_SCOPE("Serialization::loadScene");
+	MappedFile file;
+	if (!file.open(path)) return false;
+	if (file.size() >= sizeof(kBinaryMagic) && std::memcmp(file.data(), kBinaryMagic, sizeof(kBinaryMagic)) == 0) {
+		return loadSceneBinary(scene, camera, file, outCameraRestored);
+	}
+	return loadSceneJson(scene, camera, file, outCameraRestored);
+}
+
+bool Serialization::loadSceneJsonDom(Scene& scene, Camera* camera, const std::string& path, bool* outCameraRestored) {
+	HT_TRACE_SCOPE("Serialization::loadSceneJsonDom");
+	MappedFile file;
+	if (!file.open(path)) return false;
+	return loadSceneJsonDom(scene, camera, file, outCameraRestored);
+}
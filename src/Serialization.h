@@ -1,11 +1,59 @@
 #pragma once
 
+#include <glm/glm.hpp>
+
+#include <cstdint>
 #include <string>
+#include <vector>
 
 class Scene;
 class Camera;
 
 namespace Serialization {
+	// Picks the format from the extension: binary for .hts, JSON otherwise.
 	bool saveScene(const Scene& scene, const Camera& camera, const std::string& path);
+
+	// JSON keeps scenes readable and easy to exchange with other tools. Curves are streamed to the file
+	// without building a JsonCpp document.
+	bool saveSceneJson(const Scene& scene, const Camera& camera, const std::string& path);
+
+	// Chunked binary scene: settings and layers as a JSON chunk, then a curve table and packed point
+	// blocks. compress deflates each chunk at the fastest level.
+	bool saveSceneBinary(const Scene& scene, const Camera& camera, const std::string& path, bool compress = true);
+
+	// A scene copied out for writing on another thread: settings, camera and layers as compact JSON plus
+	// the binary format's curve table and point blocks.
+	struct SceneSnapshot {
+		struct Curve {
+			uint32_t pointCount;
+			int32_t rootTri;
+			float rootBary[3];
+			int32_t layer;
+			uint32_t hasRest;   // restLocal follows in rest
+		};
+		std::string meta;
+		std::vector<Curve> curves;
+		std::vector<glm::vec3> points;
+		std::vector<glm::vec3> rest;
+
+		// Content hash, to tell whether anything changed since an earlier snapshot.
+		uint64_t hash() const;
+	};
+
+	// Fills out from the scene. Reusing one snapshot keeps its buffers, so repeated snapshots of a
+	// stable scene don't allocate.
+	void snapshotScene(const Scene& scene, const Camera& camera, SceneSnapshot& out);
+
+	// Writes a snapshot as a binary scene. Touches only the snapshot, so it may run on any thread.
+	bool writeSceneBinary(const SceneSnapshot& snapshot, const std::string& path, bool compress = true);
+
+	// Reads either format; binary files are recognized by their magic, not the extension.
 	bool loadScene(Scene& scene, Camera* camera, const std::string& path, bool* outCameraRestored = nullptr);
+
+	bool isBinaryScenePath(const std::string& path);
+
+	// The JsonCpp DOM writer and reader that the streaming JSON path replaced, kept for comparison in
+	// HairToolBench.
+	bool saveSceneJsonDom(const Scene& scene, const Camera& camera, const std::string& path);
+	bool loadSceneJsonDom(Scene& scene, Camera* camera, const std::string& path, bool* outCameraRestored = nullptr);
 }
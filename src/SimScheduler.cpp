@@ -0,0 +1,87 @@
+#include "SimScheduler.h"
+
+#include "HairGuides.h"
+
+#include <algorithm>
+#include <cmath>
+
+// Adaptive iterations: frames in a row before stepping down/up, and the headroom that counts as "under".
+static const int kOverFramesToDrop = 4;
+static const int kUnderFramesToRaise = 30;
+static const float kUnderBudgetFraction = 0.6f;
+// RMS relative stretch above which iterations stop dropping; past it the budget drops steps instead.
+static const float kMaxStretchError = 0.01f;
+
+int SimScheduler::beginFrame(float frameDt, const GuideSettings& settings) {
+	m_budgetMs = settings.solverBudgetMs;
+	m_adaptive = settings.adaptiveSolver;
+	const int requested = std::clamp(settings.solverIterations, 1, 64);
+	if (!m_adaptive || requested != m_requestedIterations || m_stats.iterations <= 0) {
+		m_stats.iterations = requested;
+		m_overFrames = 0;
+		m_underFrames = 0;
+	}
+	m_requestedIterations = requested;
+
+	if (!(frameDt > 0.0f)) frameDt = 0.0f;
+	m_rateTime += frameDt;
+	m_accumulator += std::min(frameDt, kMaxFrameDt);
+
+	const int wanted = (int)(m_accumulator / kFixedDt);
+	int allowed = kMaxStepsPerFrame;
+	if (m_budgetMs > 0.0f && m_stats.stepCostMs > 0.0f) {
+		// Always take at least one step so a slow solver still makes progress.
+		allowed = std::clamp((int)std::floor(m_budgetMs / m_stats.stepCostMs), 1, kMaxStepsPerFrame);
+	}
+
+	const int steps = std::min(wanted, allowed);
+	m_accumulator -= (float)steps * kFixedDt;
+	m_stats.budgetLimited = (steps < wanted);
+	if (m_stats.budgetLimited) {
+		// Drop the time we couldn't afford rather than carrying it into the next frame.
+		m_accumulator = std::fmod(m_accumulator, kFixedDt);
+	}
+	return steps;
+}
+
+void SimScheduler::endFrame(int stepsRun, double elapsedMs, const Physics::StepStats& lastStep) {
+	if (stepsRun > 0) {
+		const float cost = (float)(elapsedMs / (double)stepsRun);
+		m_stats.stepCostMs = (m_stats.stepCostMs > 0.0f) ? (m_stats.stepCostMs * 0.8f + cost * 0.2f) : cost;
+		m_stats.stretchError = m_stats.stretchError * 0.8f + lastStep.stretchError * 0.2f;
+		m_stats.awakeCurves = lastStep.simulatedCurves;
+		m_stats.sleepingCurves = lastStep.sleepingCurves;
+		m_rateSteps += stepsRun;
+		m_rateParticleSteps += (double)stepsRun * (double)lastStep.simulatedParticles;
+		if (m_adaptive && m_budgetMs > 0.0f) adaptIterations(elapsedMs);
+	}
+	if (m_rateTime >= 0.5f) {
+		m_stats.stepsPerSecond = (float)m_rateSteps / m_rateTime;
+		m_stats.particleStepsPerSecond = (float)(m_rateParticleSteps / (double)m_rateTime);
+		m_rateSteps = 0;
+		m_rateParticleSteps = 0.0;
+		m_rateTime = 0.0f;
+	}
+}
+
+void SimScheduler::adaptIterations(double frameMs) {
+	int& iters = m_stats.iterations;
+	const bool qualityLow = m_stats.stretchError > kMaxStretchError;
+	const bool over = m_stats.budgetLimited || frameMs > (double)m_budgetMs;
+	const bool under = !m_stats.budgetLimited && frameMs < (double)(m_budgetMs * kUnderBudgetFraction);
+
+	m_overFrames = over ? m_overFrames + 1 : 0;
+	m_underFrames = under ? m_underFrames + 1 : 0;
+
+	if (m_overFrames >= kOverFramesToDrop && !qualityLow && iters > kMinIterations) {
+		iters = std::max(kMinIterations, iters * 3 / 4);
+		m_overFrames = 0;
+	} else if (m_underFrames >= kUnderFramesToRaise && iters < m_requestedIterations) {
+		iters = std::min(m_requestedIterations, iters + std::max(1, iters / 4));
+		m_underFrames = 0;
+	}
+}
+
+void SimScheduler::reset() {
+	*this = SimScheduler();
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Physics.h"
+
+struct GuideSettings;
+
+// Fixed-timestep scheduler shared by the inline and threaded solver paths.
+//
+// Owns the accumulator that turns real elapsed time into whole 1/120 s solver steps, and caps how many
+// steps run per frame from a wall-time budget: the measured cost of a step decides how many fit. When the
+// solver can't keep up the surplus time is dropped (simulation runs slower than real time) instead of
+// piling up into a spiral of ever longer frames.
+//
+// With GuideSettings::adaptiveSolver the scheduler also trades constraint iterations for time: it lowers
+// the iteration count while frames overrun the budget and raises it back once there is headroom. Both
+// directions need several frames in a row (hysteresis), and iterations are never lowered while the
+// residual stretch error is already high; past that point the step count drops instead.
+class SimScheduler {
+public:
+	static constexpr float kFixedDt = 1.0f / 120.0f;
+	static constexpr float kMaxFrameDt = 1.0f / 15.0f; // clamp huge hitches
+	static constexpr int kMaxStepsPerFrame = 8;
+	static constexpr int kMinIterations = 2;
+
+	struct Stats {
+		float stepsPerSecond = 0.0f;   // steps completed per second of real time, over ~0.5 s windows
+		float stepCostMs = 0.0f;       // smoothed wall time of a single step
+		int iterations = 0;            // constraint iterations currently used
+		float stretchError = 0.0f;     // smoothed RMS relative stretch after a step
+		bool budgetLimited = false;    // last frame ran fewer steps than real time asked for
+		float particleStepsPerSecond = 0.0f; // solver throughput over the same window as stepsPerSecond
+		int awakeCurves = 0;           // after the last step
+		int sleepingCurves = 0;
+	};
+
+	// Adds frameDt seconds of real time and returns how many kFixedDt steps to run now.
+	// A solverBudgetMs <= 0 disables the budget (only kMaxStepsPerFrame applies).
+	int beginFrame(float frameDt, const GuideSettings& settings);
+	// Reports how long the steps returned by beginFrame took, and the solver stats of the last one.
+	void endFrame(int stepsRun, double elapsedMs, const Physics::StepStats& lastStep = Physics::StepStats());
+	void reset();
+
+	float fixedDt() const { return kFixedDt; }
+	// Constraint iterations for the steps of this frame.
+	int iterations() const { return m_stats.iterations; }
+	// Real time until the accumulator holds another whole step.
+	float timeToNextStep() const { return kFixedDt - m_accumulator; }
+	const Stats& stats() const { return m_stats; }
+
+private:
+	void adaptIterations(double frameMs);
+
+	float m_accumulator = 0.0f;
+	float m_budgetMs = 0.0f;
+	int m_requestedIterations = 0;
+	bool m_adaptive = false;
+	int m_overFrames = 0;
+	int m_underFrames = 0;
+
+	float m_rateTime = 0.0f;
+	int m_rateSteps = 0;
+	double m_rateParticleSteps = 0.0;
+	Stats m_stats;
+};
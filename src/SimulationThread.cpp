@@ -0,0 +1,302 @@
+#include "SimulationThread.h"
+
+#include "Scene.h"
+#include "Physics.h"
+
+#include "Log.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+
+SimulationThread::~SimulationThread() {
+	stop();
+}
+
+void SimulationThread::start() {
+	if (m_thread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = false;
+	}
+	m_thread = std::thread([this]() { threadMain(); });
+}
+
+void SimulationThread::stop() {
+	if (!m_thread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	m_thread.join();
+	m_stats = SimScheduler::Stats();
+}
+
+SimScheduler::Stats SimulationThread::stats() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void SimulationThread::reset() {
+	if (!m_hasSnapshot) return;
+	m_hasSnapshot = false;
+	m_sceneIndex.clear();
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pending.reset();
+		m_resetPending = true;
+		m_input.enabled = false;
+		m_frontReady = false;
+		m_stats = SimScheduler::Stats();
+	}
+	m_cv.notify_all();
+}
+
+void SimulationThread::buildSnapshot(const Scene& scene) {
+	const HairGuideSet& guides = scene.guides();
+	std::unique_ptr<Snapshot> snap(new Snapshot());
+	snap->generation = ++m_generation;
+	snap->mesh = scene.sharedMesh();
+	snap->bvh = scene.sharedMeshBvh();
+	snap->slotOfScene.assign(guides.curveCount(), -1);
+	for (size_t ci = 0; ci < guides.curveCount(); ci++) {
+		if (!scene.isCurveSimulated(ci)) continue; // curves outside the simulated set are frozen
+		snap->slotOfScene[ci] = (int)snap->curves.size();
+		snap->sceneIndex.push_back((int)ci);
+		snap->curves.push_back(guides.curve(ci));
+	}
+	m_sceneIndex = snap->sceneIndex;
+	m_sentRevision = guides.revision();
+	m_sentMeshVersion = scene.meshVersion();
+	m_hasSnapshot = true;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_pending = std::move(snap);
+	m_resetPending = false;
+	m_frontReady = false;
+}
+
+void SimulationThread::applyResult(Scene& scene) {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_frontReady) return;
+		std::swap(m_front, m_consumed);
+		m_frontReady = false;
+	}
+	// Results of an older snapshot describe curves that may no longer exist at those indices.
+	if (m_consumed.generation != m_generation) return;
+	if (m_consumed.curves.size() != m_sceneIndex.size()) return;
+
+	HairGuideSet& guides = scene.guides();
+	const int dragCurve = scene.isDragging() ? scene.dragCurve() : -1;
+	const int mirrorCurve = scene.dragMirrorCurve();
+	const int dragVert = scene.dragVert();
+	for (size_t i = 0; i < m_sceneIndex.size(); i++) {
+		const int ci = m_sceneIndex[i];
+		if (ci < 0 || (size_t)ci >= guides.curveCount()) continue;
+		HairCurve& c = guides.curve((size_t)ci);
+		CurveState& s = m_consumed.curves[i];
+		if (s.points.size() != c.points.size()) continue;
+
+		// The mouse moved the dragged vertex after the solver last saw it; keep the newer position.
+		const bool keepDragVert = (ci == dragCurve || ci == mirrorCurve) && dragVert > 0 && (size_t)dragVert < c.points.size();
+		glm::vec3 dragPos(0.0f);
+		if (keepDragVert) dragPos = c.points[(size_t)dragVert];
+
+		c.points.swap(s.points);
+		c.prevPoints.swap(s.prevPoints);
+		c.segmentRestLen = s.segmentRestLen;
+		c.sleep = s.sleep;
+
+		if (keepDragVert) {
+			c.points[(size_t)dragVert] = dragPos;
+			c.prevPoints[(size_t)dragVert] = dragPos;
+		}
+	}
+
+	if (!m_consumed.corrupted.empty()) {
+		HT_WARN("Removing %zu corrupted curve(s)\n", m_consumed.corrupted.size());
+		std::vector<int> toRemove = m_consumed.corrupted;
+		std::sort(toRemove.begin(), toRemove.end());
+		toRemove.erase(std::unique(toRemove.begin(), toRemove.end()), toRemove.end());
+		std::reverse(toRemove.begin(), toRemove.end());
+		guides.removeCurves(toRemove);
+	}
+}
+
+void SimulationThread::sync(Scene& scene) {
+	if (!m_thread.joinable()) return;
+
+	const GuideSettings& gs = scene.guideSettings();
+	if (!gs.enableSimulation || !scene.mesh() || !scene.meshBvh()) {
+		reset();
+		return;
+	}
+
+	// Apply the newest completed step before looking for structural edits, so the snapshot taken
+	// below starts from the state the user is looking at.
+	if (m_hasSnapshot && scene.guides().revision() == m_sentRevision && scene.meshVersion() == m_sentMeshVersion) {
+		applyResult(scene);
+	}
+	if (!m_hasSnapshot || scene.guides().revision() != m_sentRevision || scene.meshVersion() != m_sentMeshVersion) {
+		buildSnapshot(scene);
+	}
+
+	// Drag targets: the dragged vertex is pinned, its mirror peer just follows.
+	if (scene.isDragging()) {
+		const int dragVert = scene.dragVert();
+		const int curves[2] = {scene.dragCurve(), scene.dragMirrorCurve()};
+		for (int k = 0; k < 2; k++) {
+			const int ci = curves[k];
+			if (ci < 0 || (size_t)ci >= scene.guides().curveCount()) continue;
+			const HairCurve& c = scene.guides().curve((size_t)ci);
+			if (dragVert <= 0 || (size_t)dragVert >= c.points.size()) continue;
+			DragInput d;
+			d.generation = m_generation;
+			d.sceneCurve = ci;
+			d.vert = dragVert;
+			d.pos = c.points[(size_t)dragVert];
+			d.pinned = (k == 0);
+			if (!m_dragQueue.push(d)) break; // full: the solver is behind, a later frame resends
+		}
+	}
+
+	FrameInput& in = m_inputScratch;
+	in.enabled = true;
+	in.settings = gs;
+	in.generation = m_generation;
+	in.dragging = scene.isDragging();
+	in.gravity.clear();
+	if (scene.gravityOverrideHeld()) {
+		in.gravity.reserve(m_sceneIndex.size());
+		for (int ci : m_sceneIndex) in.gravity.push_back(scene.effectiveGravityForCurve((size_t)ci));
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		std::swap(m_input, in);
+	}
+	m_cv.notify_all();
+}
+
+void SimulationThread::threadMain() {
+	Trace::setThreadName("Simulation");
+
+	using Clock = std::chrono::steady_clock;
+
+	// Same pacing as the inline path; a batch is what the inline path would run in one frame.
+	SimScheduler scheduler;
+	FrameInput input;
+	Clock::time_point last = Clock::now();
+	int pinnedCurve = -1;
+	int pinnedVert = -1;
+	std::vector<int> corrupted;
+	Physics::StepContext ctx;
+
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cv.wait(lock, [&]() { return m_stop || m_pending || m_resetPending || (m_input.enabled && !m_sim.curves.empty()); });
+			if (m_stop) break;
+			if (m_resetPending) {
+				m_resetPending = false;
+				m_sim = Snapshot();
+				scheduler.reset();
+			}
+			if (m_pending) {
+				m_sim = std::move(*m_pending);
+				m_pending.reset();
+				pinnedCurve = -1;
+				pinnedVert = -1;
+				corrupted.clear();
+			}
+			input = m_input;
+		}
+		if (!input.enabled || m_sim.curves.empty() || input.generation != m_sim.generation) {
+			// Nothing to simulate yet; wait for the next sync instead of spinning.
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cv.wait_for(lock, std::chrono::milliseconds(5));
+			last = Clock::now();
+			continue;
+		}
+
+		DragInput d;
+		while (m_dragQueue.pop(d)) {
+			if (d.generation != m_sim.generation) continue;
+			if (d.sceneCurve < 0 || (size_t)d.sceneCurve >= m_sim.slotOfScene.size()) continue;
+			const int slot = m_sim.slotOfScene[(size_t)d.sceneCurve];
+			if (slot < 0) continue;
+			HairCurve& c = m_sim.curves[(size_t)slot];
+			if (d.vert <= 0 || (size_t)d.vert >= c.points.size()) continue;
+			c.points[(size_t)d.vert] = d.pos;
+			c.prevPoints[(size_t)d.vert] = d.pos;
+			if (d.pinned) {
+				pinnedCurve = slot;
+				pinnedVert = d.vert;
+			}
+		}
+		if (!input.dragging) {
+			pinnedCurve = -1;
+			pinnedVert = -1;
+		}
+
+		const Clock::time_point now = Clock::now();
+		const float frameDt = std::chrono::duration<float>(now - last).count();
+		last = now;
+		const int steps = scheduler.beginFrame(frameDt, input.settings);
+
+		ctx.mesh = m_sim.mesh.get();
+		ctx.bvh = m_sim.bvh.get();
+		ctx.settings = &input.settings;
+		ctx.curves.clear();
+		for (HairCurve& c : m_sim.curves) ctx.curves.push_back(&c);
+		ctx.gravity = input.gravity;
+		ctx.dragCurve = pinnedCurve;
+		ctx.dragVert = pinnedVert;
+		ctx.iterations = scheduler.iterations();
+		Physics::StepStats stats;
+
+		const uint64_t t0 = Trace::nowNs();
+		for (int i = 0; i < steps; i++) {
+			HT_TRACE_SCOPE("SimulationThread::step");
+			const size_t corruptedBefore = corrupted.size();
+			Physics::stepCurves(ctx, scheduler.fixedDt(), &corrupted, (i + 1 == steps) ? &stats : nullptr);
+			// Clear broken curves so they aren't stepped again; the main thread removes them, which
+			// triggers a new snapshot.
+			for (size_t k = corruptedBefore; k < corrupted.size(); k++) m_sim.curves[(size_t)corrupted[k]].points.clear();
+		}
+		scheduler.endFrame(steps, (double)(Trace::nowNs() - t0) * 1e-6, stats);
+
+		if (steps > 0) {
+			m_back.generation = m_sim.generation;
+			m_back.curves.resize(m_sim.curves.size());
+			for (size_t i = 0; i < m_sim.curves.size(); i++) {
+				const HairCurve& c = m_sim.curves[i];
+				CurveState& s = m_back.curves[i];
+				s.points = c.points;
+				s.prevPoints = c.prevPoints;
+				s.segmentRestLen = c.segmentRestLen;
+				s.sleep = c.sleep;
+			}
+			// Every batch reports all corrupted curves of this snapshot, so none are lost if the main
+			// thread skips a result.
+			m_back.corrupted.clear();
+			for (int slot : corrupted) m_back.corrupted.push_back(m_sim.sceneIndex[(size_t)slot]);
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (m_pending == nullptr && !m_resetPending) {
+					std::swap(m_front, m_back);
+					m_frontReady = true;
+				}
+				m_stats = scheduler.stats();
+			}
+		}
+
+		// Sleep until the next step is due (woken early by sync/stop).
+		const int waitUs = (int)(scheduler.timeToNextStep() * 1e6f);
+		if (waitUs > 0) {
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cv.wait_for(lock, std::chrono::microseconds(waitUs), [&]() { return m_stop || m_pending || m_resetPending; });
+		}
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "HairGuides.h"
+#include "SimScheduler.h"
+#include "SpscQueue.h"
+
+#include <glm/glm.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class Scene;
+class Mesh;
+class Bvh;
+
+// Runs the CPU solver on a dedicated thread so a slow step never blocks the UI or vsync.
+//
+// The thread owns a private copy of the simulated curves (Scene::isCurveSimulated), which acts as the back buffer.
+// After each batch of steps it copies the particle state into a publish buffer and swaps it with the
+// front buffer; the main thread applies the latest front buffer to the scene once per frame, so the
+// renderer always draws the last completed step. Structural edits (curves added/removed/resampled,
+// selection) resnapshot the simulated set, and drag targets go through a lock-free queue.
+class SimulationThread {
+public:
+	SimulationThread() = default;
+	~SimulationThread();
+
+	void start();
+	void stop();
+	bool isRunning() const { return m_thread.joinable(); }
+	// True while the thread owns a snapshot of the scene (the inline solver must not run).
+	bool isActive() const { return m_hasSnapshot; }
+
+	// Main thread, once per frame after input handling and before rendering.
+	void sync(Scene& scene);
+
+	// Drops the solver's copy of the curves (simulation switched off or moved back inline).
+	// The scene keeps the last applied state.
+	void reset();
+
+	// Scheduler stats from the solver thread (see SimScheduler).
+	SimScheduler::Stats stats() const;
+
+private:
+	struct CurveState {
+		std::vector<glm::vec3> points;
+		std::vector<glm::vec3> prevPoints;
+		float segmentRestLen = 0.0f;
+		HairCurveSleep sleep;
+	};
+
+	struct Snapshot {
+		uint64_t generation = 0;
+		std::shared_ptr<const Mesh> mesh;
+		std::shared_ptr<const Bvh> bvh;
+		std::vector<HairCurve> curves;
+		std::vector<int> sceneIndex;   // scene curve index per simulated curve
+		std::vector<int> slotOfScene;  // simulated index per scene curve, -1 if not simulated
+	};
+
+	struct FrameInput {
+		bool enabled = false;
+		GuideSettings settings;
+		uint64_t generation = 0;
+		std::vector<float> gravity;     // per simulated curve while the gravity override is held, else empty
+		bool dragging = false;
+	};
+
+	struct Result {
+		uint64_t generation = 0;
+		std::vector<CurveState> curves;
+		std::vector<int> corrupted;    // scene indices
+	};
+
+	struct DragInput {
+		uint64_t generation = 0;
+		int sceneCurve = -1;
+		int vert = -1;
+		glm::vec3 pos{0.0f};
+		bool pinned = false;           // the vertex under the mouse (as opposed to its mirror peer)
+	};
+
+	void threadMain();
+	void buildSnapshot(const Scene& scene);
+	void applyResult(Scene& scene);
+
+	std::thread m_thread;
+
+	// Shared state, guarded by m_mutex (held only to hand buffers over).
+	mutable std::mutex m_mutex;
+	std::condition_variable m_cv;
+	bool m_stop = false;
+	bool m_resetPending = false;
+	std::unique_ptr<Snapshot> m_pending;
+	FrameInput m_input;
+	Result m_front;
+	bool m_frontReady = false;
+
+	SpscQueue<DragInput, 64> m_dragQueue;
+	SimScheduler::Stats m_stats;
+
+	// Main-thread state
+	bool m_hasSnapshot = false;
+	uint64_t m_generation = 0;
+	uint64_t m_sentRevision = 0;
+	uint64_t m_sentMeshVersion = 0;
+	std::vector<int> m_sceneIndex;
+	Result m_consumed;
+	FrameInput m_inputScratch;
+
+	// Simulation-thread state
+	Snapshot m_sim;
+	Result m_back;
+};
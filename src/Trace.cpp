@@ -0,0 +1,236 @@
+#include "Trace.h"
+
+#include "Log.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Trace::detail::g_enabled{false};
+
+namespace {
+	enum class EventType : uint8_t { Begin, End, Complete, Counter };
+
+	struct Event {
+		uint64_t ts;
+		uint64_t dur;
+		const char* name;
+		double value;
+		EventType type;
+	};
+
+	// ~2.5 MB per thread that records events; at a few hundred events per frame this holds minutes of a
+	// session.
+	constexpr uint64_t kRingSize = 1u << 16;
+
+	// Single-producer ring: only the owning thread writes, readers copy without locking and discard
+	// any slot the producer may have overwritten while it was being copied.
+	struct ThreadRing {
+		std::vector<Event> events; // allocated on the first push, so naming a thread costs no ring
+		std::atomic<uint64_t> head{0};
+		uint32_t tid = 0;
+		std::string name;
+	};
+
+	struct Registry {
+		std::mutex mutex; // guards registration and thread names only, never the event path
+		std::vector<std::shared_ptr<ThreadRing>> rings;
+		uint32_t nextTid = 1;
+		std::string exitPath;
+	};
+
+	static Registry& registry() {
+		static Registry r;
+		return r;
+	}
+
+	static ThreadRing& threadRing() {
+		thread_local std::shared_ptr<ThreadRing> ring;
+		if (!ring) {
+			ring = std::make_shared<ThreadRing>();
+			Registry& r = registry();
+			std::lock_guard<std::mutex> lock(r.mutex);
+			ring->tid = r.nextTid++;
+			r.rings.push_back(ring);
+		}
+		return *ring;
+	}
+
+	static void push(const char* name, EventType type, uint64_t ts, uint64_t dur, double value) {
+		ThreadRing& ring = threadRing();
+		// Readers only touch events once head is non-zero, which is published after this.
+		if (ring.events.empty()) ring.events.resize(kRingSize);
+		const uint64_t h = ring.head.load(std::memory_order_relaxed);
+		ring.events[h % kRingSize] = Event{ts, dur, name, value, type};
+		ring.head.store(h + 1, std::memory_order_release);
+	}
+
+	static std::atomic<uint64_t> g_clearedBeforeNs{0};
+
+	static void writeEscaped(FILE* f, const char* s) {
+		for (; *s; s++) {
+			if (*s == '"' || *s == '\\') std::fputc('\\', f);
+			std::fputc(*s, f);
+		}
+	}
+}
+
+void Trace::setEnabled(bool enabled) {
+	detail::g_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+uint64_t Trace::nowNs() {
+	using namespace std::chrono;
+	return (uint64_t)duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Trace::setThreadName(const char* name) {
+	ThreadRing& ring = threadRing();
+	std::lock_guard<std::mutex> lock(registry().mutex);
+	ring.name = name ? name : "";
+}
+
+void Trace::begin(const char* name) {
+	if (!enabled()) return;
+	push(name, EventType::Begin, nowNs(), 0, 0.0);
+}
+
+void Trace::end(const char* name) {
+	// Always record ends so a scope that started while enabled is closed in the trace.
+	push(name, EventType::End, nowNs(), 0, 0.0);
+}
+
+void Trace::complete(const char* name, uint64_t startNs, uint64_t endNs) {
+	if (!enabled()) return;
+	push(name, EventType::Complete, startNs, endNs > startNs ? endNs - startNs : 0, 0.0);
+}
+
+void Trace::counter(const char* name, double value) {
+	if (!enabled()) return;
+	push(name, EventType::Counter, nowNs(), 0, value);
+}
+
+void Trace::clear() {
+	// The producers own their rings, so instead of touching them just hide everything recorded so far.
+	g_clearedBeforeNs.store(nowNs(), std::memory_order_relaxed);
+}
+
+bool Trace::writeChromeTrace(const std::string& path, std::string* outError) {
+	if (outError) outError->clear();
+
+	struct Snapshot {
+		uint32_t tid;
+		std::string name;
+		std::vector<Event> events;
+	};
+	std::vector<Snapshot> threads;
+	{
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		for (const auto& ring : r.rings) threads.push_back({ring->tid, ring->name, {}});
+		for (size_t ti = 0; ti < r.rings.size(); ti++) {
+			const ThreadRing& ring = *r.rings[ti];
+			const uint64_t headBefore = ring.head.load(std::memory_order_acquire);
+			const uint64_t first = (headBefore > kRingSize) ? headBefore - kRingSize : 0;
+			std::vector<Event> copy;
+			copy.reserve((size_t)(headBefore - first));
+			for (uint64_t i = first; i < headBefore; i++) copy.push_back(ring.events[i % kRingSize]);
+			// Slots below headAfter + 1 - kRingSize may have been rewritten during the copy, including
+			// headAfter's own slot, which the producer may be writing right now.
+			const uint64_t headAfter = ring.head.load(std::memory_order_acquire);
+			const uint64_t valid = (headAfter + 1 > kRingSize) ? headAfter + 1 - kRingSize : 0;
+			const size_t skip = (size_t)((valid > first) ? std::min(valid - first, (uint64_t)copy.size()) : 0);
+			copy.erase(copy.begin(), copy.begin() + (ptrdiff_t)skip);
+			threads[ti].events = std::move(copy);
+		}
+	}
+
+	const uint64_t floorNs = g_clearedBeforeNs.load(std::memory_order_relaxed);
+	uint64_t base = UINT64_MAX;
+	size_t total = 0;
+	for (Snapshot& t : threads) {
+		auto& ev = t.events;
+		ev.erase(std::remove_if(ev.begin(), ev.end(), [&](const Event& e) { return e.ts < floorNs; }), ev.end());
+		// A ring that wrapped may start with End events whose Begin was overwritten; drop them.
+		int depth = 0;
+		size_t keepFrom = 0;
+		for (size_t i = 0; i < ev.size(); i++) {
+			if (ev[i].type == EventType::Begin) depth++;
+			else if (ev[i].type == EventType::End && --depth < 0) {
+				depth = 0;
+				keepFrom = i + 1;
+			}
+		}
+		ev.erase(ev.begin(), ev.begin() + (ptrdiff_t)keepFrom);
+		for (const Event& e : ev) base = std::min(base, e.ts);
+		total += ev.size();
+	}
+	if (total == 0) {
+		if (outError) *outError = enabled() ? "No trace events recorded yet" : "Tracing is disabled";
+		return false;
+	}
+
+	FILE* f = std::fopen(path.c_str(), "wb");
+	if (!f) {
+		if (outError) *outError = "Failed to open " + path;
+		return false;
+	}
+	std::fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	std::fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"HairTool\"}}");
+	for (const Snapshot& t : threads) {
+		if (t.events.empty()) continue;
+		if (!t.name.empty()) {
+			std::fprintf(f, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"", t.tid);
+			writeEscaped(f, t.name.c_str());
+			std::fprintf(f, "\"}}");
+		}
+		for (const Event& e : t.events) {
+			const double ts = (double)(e.ts - base) * 1e-3;
+			std::fprintf(f, ",\n{\"name\":\"");
+			writeEscaped(f, e.name);
+			switch (e.type) {
+				case EventType::Begin:
+					std::fprintf(f, "\",\"ph\":\"B\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}", t.tid, ts);
+					break;
+				case EventType::End:
+					std::fprintf(f, "\",\"ph\":\"E\",\"pid\":1,\"tid\":%u,\"ts\":%.3f}", t.tid, ts);
+					break;
+				case EventType::Complete:
+					std::fprintf(f, "\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", t.tid, ts, (double)e.dur * 1e-3);
+					break;
+				case EventType::Counter:
+					std::fprintf(f, "\",\"ph\":\"C\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"args\":{\"value\":%.17g}}", t.tid, ts, e.value);
+					break;
+			}
+		}
+	}
+	std::fprintf(f, "\n]}\n");
+	const bool ok = (std::fclose(f) == 0);
+	if (!ok && outError) *outError = "Failed to write " + path;
+	return ok;
+}
+
+void Trace::setExitPath(const std::string& path) {
+	Registry& r = registry();
+	std::lock_guard<std::mutex> lock(r.mutex);
+	r.exitPath = path;
+}
+
+void Trace::shutdown() {
+	std::string path;
+	{
+		Registry& r = registry();
+		std::lock_guard<std::mutex> lock(r.mutex);
+		path = r.exitPath;
+	}
+	if (path.empty()) return;
+	std::string err;
+	if (writeChromeTrace(path, &err)) {
+		std::printf("Wrote trace %s\n", path.c_str());
+	} else {
+		HT_ERR("Trace: %s\n", err.c_str());
+	}
+}
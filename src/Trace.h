@@ -0,0 +1,72 @@
+#pragma once
+
+// Event tracing for offline analysis (Chrome trace / Perfetto JSON).
+// Each thread records begin/end/counter events into its own lock-free ring buffer; nothing is
+// recorded until Trace::setEnabled(true), and a disabled scope costs one relaxed atomic load.
+// Event names must be string literals (only the pointer is stored).
+// Compiled out together with the profiler when HAIRTOOL_ENABLE_PROFILER=0.
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#ifndef HAIRTOOL_ENABLE_PROFILER
+	#define HAIRTOOL_ENABLE_PROFILER 1
+#endif
+
+namespace Trace {
+	namespace detail {
+		extern std::atomic<bool> g_enabled;
+	}
+
+	inline bool enabled() { return detail::g_enabled.load(std::memory_order_relaxed); }
+	void setEnabled(bool enabled);
+
+	// Monotonic timestamp shared with the profiler.
+	uint64_t nowNs();
+
+	// Names the calling thread in the trace viewer.
+	void setThreadName(const char* name);
+
+	void begin(const char* name);
+	void end(const char* name);
+	// Span with explicit timestamps (nowNs clock), e.g. for frames closed after the fact.
+	void complete(const char* name, uint64_t startNs, uint64_t endNs);
+	void counter(const char* name, double value);
+
+	// Drops all recorded events (thread registrations are kept).
+	void clear();
+
+	// Writes every thread's retained events as Chrome trace JSON.
+	bool writeChromeTrace(const std::string& path, std::string* outError = nullptr);
+
+	// If set, shutdown() writes the trace there (used by `--trace <file>`).
+	void setExitPath(const std::string& path);
+	void shutdown();
+
+	class Scope {
+	public:
+		explicit Scope(const char* name) : m_name(enabled() ? name : nullptr) {
+			if (m_name) begin(m_name);
+		}
+		~Scope() {
+			if (m_name) end(m_name);
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		const char* m_name;
+	};
+}
+
+#define HT_TRACE_CONCAT_INNER(a, b) a##b
+#define HT_TRACE_CONCAT(a, b) HT_TRACE_CONCAT_INNER(a, b)
+
+#if HAIRTOOL_ENABLE_PROFILER
+	#define HT_TRACE_SCOPE(name) ::Trace::Scope HT_TRACE_CONCAT(htTraceScope_, __LINE__)(name)
+	#define HT_TRACE_COUNTER(name, value) do { if (::Trace::enabled()) ::Trace::counter(name, (double)(value)); } while (0)
+#else
+	#define HT_TRACE_SCOPE(name) ((void)0)
+	#define HT_TRACE_COUNTER(name, value) ((void)0)
+#endif
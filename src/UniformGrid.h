@@ -0,0 +1,35 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cmath>
+#include <cstdint>
+
+// Cell coordinates and hash keys for the uniform-grid broadphases (curve-curve collision, duplicate
+// roots on import). Callers bucket points by key and look at the 27 cells around a query point.
+namespace UniformGrid {
+	// Cell index along one axis. Out-of-range and NaN coordinates land in a defined cell (NaN in 0)
+	// instead of hitting an undefined float-to-int cast.
+	inline int cellCoord(float v, float invCell) {
+		const float c = std::floor(v * invCell);
+		const float limit = 1073741824.0f; // 2^30
+		if (!(c > -limit)) return (c != c) ? 0 : -(1 << 30);
+		if (!(c < limit)) return 1 << 30;
+		return (int)c;
+	}
+
+	inline glm::ivec3 cellOf(const glm::vec3& p, float invCell) {
+		return glm::ivec3(cellCoord(p.x, invCell), cellCoord(p.y, invCell), cellCoord(p.z, invCell));
+	}
+
+	// Packs 21 bits per axis, so cells 2^21 apart alias. Aliased cells only add candidates, which the
+	// callers' exact distance test rejects.
+	inline uint64_t cellKey(int x, int y, int z) {
+		const uint64_t m = 0x1FFFFF;
+		return (((uint64_t)x & m) << 42) | (((uint64_t)y & m) << 21) | ((uint64_t)z & m);
+	}
+
+	inline uint64_t cellKey(const glm::ivec3& c) {
+		return cellKey(c.x, c.y, c.z);
+	}
+}
@@ -28,7 +28,7 @@ std::string UserSettings::settingsPath() {
 	return settingsFilePath().string();
 }
 
-bool UserSettings::load(Scene& scene, float viewportBg[3], bool& showControlsOverlay, bool& showLayersPanel, float& uiScale, int& windowWidth, int& windowHeight, bool& windowMaximized) {
+bool UserSettings::load(Scene& scene, float viewportBg[3], bool& showControlsOverlay, bool& showLayersPanel, float& uiScale, int& windowWidth, int& windowHeight, bool& windowMaximized, bool& autosaveEnabled, float& autosaveMinutes) {
 	std::filesystem::path path = settingsFilePath();
 	if (!std::filesystem::exists(path)) return false;
 
@@ -51,13 +51,26 @@ bool UserSettings::load(Scene& scene, float viewportBg[3], bool& showControlsOve
 		gs.enableSimulation = jgs.get("enableSimulation", gs.enableSimulation).asBool();
 		gs.enableMeshCollision = jgs.get("enableMeshCollision", gs.enableMeshCollision).asBool();
 		gs.enableCurveCollision = jgs.get("enableCurveCollision", gs.enableCurveCollision).asBool();
+		gs.continuousCollision = jgs.get("continuousCollision", gs.continuousCollision).asBool();
 		gs.enableGpuSolver = jgs.get("enableGpuSolver", gs.enableGpuSolver).asBool();
+		gs.simulationThread = jgs.get("simulationThread", gs.simulationThread).asBool();
+		gs.simulateAll = jgs.get("simulateAll", gs.simulateAll).asBool();
 		gs.collisionThickness = jgs.get("collisionThickness", gs.collisionThickness).asFloat();
 		gs.collisionFriction = jgs.get("collisionFriction", gs.collisionFriction).asFloat();
 		gs.solverIterations = jgs.get("solverIterations", gs.solverIterations).asInt();
+		gs.solverBudgetMs = jgs.get("solverBudgetMs", gs.solverBudgetMs).asFloat();
+		gs.adaptiveSolver = jgs.get("adaptiveSolver", gs.adaptiveSolver).asBool();
+		gs.enableSleeping = jgs.get("enableSleeping", gs.enableSleeping).asBool();
+		gs.sleepThreshold = jgs.get("sleepThreshold", gs.sleepThreshold).asFloat();
 		gs.gravity = jgs.get("gravity", gs.gravity).asFloat();
 		gs.damping = jgs.get("damping", gs.damping).asFloat();
 		gs.stiffness = jgs.get("stiffness", gs.stiffness).asFloat();
+		gs.directStretchSolve = jgs.get("directStretchSolve", gs.directStretchSolve).asBool();
+		gs.rodBending = jgs.get("rodBending", gs.rodBending).asBool();
+		gs.shapeStiffness = jgs.get("shapeStiffness", gs.shapeStiffness).asFloat();
+		gs.shapeHold = jgs.get("shapeHold", gs.shapeHold).asFloat();
+		gs.useXpbd = jgs.get("useXpbd", gs.useXpbd).asBool();
+		gs.bendCompliance = jgs.get("bendCompliance", gs.bendCompliance).asFloat();
 		gs.dragLerp = jgs.get("dragLerp", gs.dragLerp).asFloat();
 	}
 
@@ -81,6 +94,8 @@ bool UserSettings::load(Scene& scene, float viewportBg[3], bool& showControlsOve
 		windowWidth = ui.get("windowWidth", windowWidth).asInt();
 		windowHeight = ui.get("windowHeight", windowHeight).asInt();
 		windowMaximized = ui.get("windowMaximized", windowMaximized).asBool();
+		autosaveEnabled = ui.get("autosaveEnabled", autosaveEnabled).asBool();
+		autosaveMinutes = ui.get("autosaveMinutes", autosaveMinutes).asFloat();
 	}
 
 	// Viewport background
@@ -94,7 +109,7 @@ bool UserSettings::load(Scene& scene, float viewportBg[3], bool& showControlsOve
 	return true;
 }
 
-bool UserSettings::save(const Scene& scene, const float viewportBg[3], bool showControlsOverlay, bool showLayersPanel, float uiScale, int windowWidth, int windowHeight, bool windowMaximized) {
+bool UserSettings::save(const Scene& scene, const float viewportBg[3], bool showControlsOverlay, bool showLayersPanel, float uiScale, int windowWidth, int windowHeight, bool windowMaximized, bool autosaveEnabled, float autosaveMinutes) {
 	std::filesystem::path path = settingsFilePath();
 	std::error_code ec;
 	std::filesystem::create_directories(path.parent_path(), ec);
@@ -110,13 +125,26 @@ bool UserSettings::save(const Scene& scene, const float viewportBg[3], bool show
 	jgs["enableSimulation"] = gs.enableSimulation;
 	jgs["enableMeshCollision"] = gs.enableMeshCollision;
 	jgs["enableCurveCollision"] = gs.enableCurveCollision;
+	jgs["continuousCollision"] = gs.continuousCollision;
 	jgs["enableGpuSolver"] = gs.enableGpuSolver;
+	jgs["simulationThread"] = gs.simulationThread;
+	jgs["simulateAll"] = gs.simulateAll;
 	jgs["collisionThickness"] = gs.collisionThickness;
 	jgs["collisionFriction"] = gs.collisionFriction;
 	jgs["solverIterations"] = gs.solverIterations;
+	jgs["solverBudgetMs"] = gs.solverBudgetMs;
+	jgs["adaptiveSolver"] = gs.adaptiveSolver;
+	jgs["enableSleeping"] = gs.enableSleeping;
+	jgs["sleepThreshold"] = gs.sleepThreshold;
 	jgs["gravity"] = gs.gravity;
 	jgs["damping"] = gs.damping;
 	jgs["stiffness"] = gs.stiffness;
+	jgs["directStretchSolve"] = gs.directStretchSolve;
+	jgs["rodBending"] = gs.rodBending;
+	jgs["shapeStiffness"] = gs.shapeStiffness;
+	jgs["shapeHold"] = gs.shapeHold;
+	jgs["useXpbd"] = gs.useXpbd;
+	jgs["bendCompliance"] = gs.bendCompliance;
 	jgs["dragLerp"] = gs.dragLerp;
 	root["guideSettings"] = jgs;
 
@@ -138,6 +166,8 @@ bool UserSettings::save(const Scene& scene, const float viewportBg[3], bool show
 	ui["windowWidth"] = windowWidth;
 	ui["windowHeight"] = windowHeight;
 	ui["windowMaximized"] = windowMaximized;
+	ui["autosaveEnabled"] = autosaveEnabled;
+	ui["autosaveMinutes"] = autosaveMinutes;
 	root["ui"] = ui;
 
 	Json::Value bg(Json::arrayValue);
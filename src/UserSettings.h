@@ -7,10 +7,10 @@ class Scene;
 namespace UserSettings {
 	// Loads persistent user settings (tool UI + guide/render settings).
 	// Returns true if a settings file was found and parsed.
-	bool load(Scene& scene, float viewportBg[3], bool& showControlsOverlay, bool& showLayersPanel, float& uiScale, int& windowWidth, int& windowHeight, bool& windowMaximized);
+	bool load(Scene& scene, float viewportBg[3], bool& showControlsOverlay, bool& showLayersPanel, float& uiScale, int& windowWidth, int& windowHeight, bool& windowMaximized, bool& autosaveEnabled, float& autosaveMinutes);
 
 	// Saves persistent user settings (tool UI + guide/render settings).
-	bool save(const Scene& scene, const float viewportBg[3], bool showControlsOverlay, bool showLayersPanel, float uiScale, int windowWidth, int windowHeight, bool windowMaximized);
+	bool save(const Scene& scene, const float viewportBg[3], bool showControlsOverlay, bool showLayersPanel, float uiScale, int windowWidth, int windowHeight, bool windowMaximized, bool autosaveEnabled, float autosaveMinutes);
 
 	// For debugging / UI (optional): absolute path to the settings file.
 	std::string settingsPath();
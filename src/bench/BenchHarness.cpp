@@ -0,0 +1,181 @@
+#include "BenchHarness.h"
+
+#include <json/json.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <new>
+
+// Every allocation carries a header with its size so delete can subtract it again.
+static std::atomic<size_t> g_heapBytes{0};
+static std::atomic<size_t> g_peakHeapBytes{0};
+static constexpr size_t kHeapHeader = alignof(std::max_align_t);
+
+static void* trackedAlloc(size_t size) {
+	char* p = (char*)std::malloc(size + kHeapHeader);
+	if (!p) return nullptr;
+	*(size_t*)p = size;
+	const size_t now = g_heapBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	size_t peak = g_peakHeapBytes.load(std::memory_order_relaxed);
+	while (now > peak && !g_peakHeapBytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+	return p + kHeapHeader;
+}
+
+static void trackedFree(void* ptr) {
+	if (!ptr) return;
+	char* p = (char*)ptr - kHeapHeader;
+	g_heapBytes.fetch_sub(*(size_t*)p, std::memory_order_relaxed);
+	std::free(p);
+}
+
+void* operator new(size_t size) {
+	if (void* p = trackedAlloc(size)) return p;
+	throw std::bad_alloc();
+}
+void* operator new[](size_t size) {
+	if (void* p = trackedAlloc(size)) return p;
+	throw std::bad_alloc();
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedAlloc(size); }
+void operator delete(void* p) noexcept { trackedFree(p); }
+void operator delete[](void* p) noexcept { trackedFree(p); }
+void operator delete(void* p, size_t) noexcept { trackedFree(p); }
+void operator delete[](void* p, size_t) noexcept { trackedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { trackedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { trackedFree(p); }
+
+size_t Bench::heapBytes() {
+	return g_heapBytes.load(std::memory_order_relaxed);
+}
+
+size_t Bench::peakHeapBytes() {
+	return g_peakHeapBytes.load(std::memory_order_relaxed);
+}
+
+void Bench::resetPeakHeap() {
+	g_peakHeapBytes.store(g_heapBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+bool Bench::Harness::wants(const std::string& name) const {
+	return m_options.filter.empty() || name.find(m_options.filter) != std::string::npos;
+}
+
+Bench::Result* Bench::Harness::run(const std::string& name, int size, const std::function<void()>& body, const std::function<void()>& setup) {
+	std::string fullName = (size > 0) ? (name + "/" + std::to_string(size)) : name;
+	if (!wants(fullName)) return nullptr;
+
+	using Clock = std::chrono::steady_clock;
+	std::vector<double> samples;
+	double total = 0.0;
+	const auto start = Clock::now();
+	while ((int)samples.size() < m_options.maxIterations) {
+		if (setup) setup();
+		const auto t0 = Clock::now();
+		body();
+		const auto t1 = Clock::now();
+		double ms = std::chrono::duration<double, std::milli>(t1 - t0).count();
+		samples.push_back(ms);
+		total += ms;
+
+		const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+		if ((int)samples.size() >= m_options.minIterations && elapsed >= m_options.minSeconds) break;
+	}
+
+	Result r;
+	r.name = name;
+	r.size = size;
+	r.iterations = (int)samples.size();
+	r.meanMs = total / (double)samples.size();
+	std::vector<double> sorted = samples;
+	std::sort(sorted.begin(), sorted.end());
+	r.minMs = sorted.front();
+	r.maxMs = sorted.back();
+	const size_t mid = sorted.size() / 2;
+	r.medianMs = (sorted.size() % 2) ? sorted[mid] : 0.5 * (sorted[mid - 1] + sorted[mid]);
+	double var = 0.0;
+	for (double s : samples) var += (s - r.meanMs) * (s - r.meanMs);
+	r.stddevMs = std::sqrt(var / (double)samples.size());
+
+	std::printf("%-40s %8d iters  median %10.4f ms  mean %10.4f ms  min %10.4f ms\n",
+		fullName.c_str(), r.iterations, r.medianMs, r.meanMs, r.minMs);
+	std::fflush(stdout);
+
+	m_results.push_back(std::move(r));
+	return &m_results.back();
+}
+
+bool Bench::Harness::writeJson(const std::string& path, const std::map<std::string, std::string>& meta) const {
+	Json::Value root;
+	for (const auto& kv : meta) root["meta"][kv.first] = kv.second;
+
+	Json::Value results(Json::arrayValue);
+	for (const Result& r : m_results) {
+		Json::Value jr;
+		jr["name"] = r.name;
+		jr["size"] = r.size;
+		jr["iterations"] = r.iterations;
+		jr["mean_ms"] = r.meanMs;
+		jr["median_ms"] = r.medianMs;
+		jr["min_ms"] = r.minMs;
+		jr["max_ms"] = r.maxMs;
+		jr["stddev_ms"] = r.stddevMs;
+		if (!r.counters.empty()) {
+			Json::Value jc;
+			for (const auto& kv : r.counters) jc[kv.first] = kv.second;
+			jr["counters"] = jc;
+		}
+		results.append(jr);
+	}
+	root["results"] = results;
+
+	Json::StreamWriterBuilder wb;
+	wb["indentation"] = "  ";
+	std::unique_ptr<Json::StreamWriter> writer(wb.newStreamWriter());
+
+	std::ofstream f(path, std::ios::binary);
+	if (!f.is_open()) return false;
+	writer->write(root, &f);
+	return true;
+}
+
+int Bench::Harness::compareWithBaseline(const std::string& baselinePath, double thresholdPct) const {
+	std::ifstream f(baselinePath, std::ios::binary);
+	if (!f.is_open()) {
+		std::fprintf(stderr, "Cannot open baseline %s\n", baselinePath.c_str());
+		return 0;
+	}
+	Json::CharReaderBuilder rb;
+	Json::Value root;
+	std::string errs;
+	if (!Json::parseFromStream(rb, f, &root, &errs)) {
+		std::fprintf(stderr, "Cannot parse baseline %s: %s\n", baselinePath.c_str(), errs.c_str());
+		return 0;
+	}
+
+	std::map<std::string, double> baseline;
+	const Json::Value& jr = root["results"];
+	for (Json::ArrayIndex i = 0; i < jr.size(); i++) {
+		std::string key = jr[i]["name"].asString() + "/" + std::to_string(jr[i]["size"].asInt());
+		baseline[key] = jr[i]["median_ms"].asDouble();
+	}
+
+	int regressions = 0;
+	std::printf("\nComparison against %s (threshold %.1f%%)\n", baselinePath.c_str(), thresholdPct);
+	for (const Result& r : m_results) {
+		std::string key = r.name + "/" + std::to_string(r.size);
+		auto it = baseline.find(key);
+		if (it == baseline.end() || it->second <= 0.0) continue;
+		double deltaPct = 100.0 * (r.medianMs - it->second) / it->second;
+		const bool regressed = deltaPct > thresholdPct;
+		if (regressed) regressions++;
+		std::printf("%-40s %10.4f -> %10.4f ms  %+7.1f%%%s\n", key.c_str(), it->second, r.medianMs, deltaPct, regressed ? "  REGRESSION" : "");
+	}
+	return regressions;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// Small in-house benchmark harness for HairToolBench.
+// Each case is timed with a steady clock until both a minimum iteration count and a minimum
+// wall time are reached; results are kept in memory and written out as JSON for tracking.
+namespace Bench {
+	struct Options {
+		double minSeconds = 0.5;    // per case
+		int minIterations = 5;
+		int maxIterations = 100000;
+		std::string filter;         // substring match on case name; empty = run all
+	};
+
+	struct Result {
+		std::string name;
+		int size = 0;               // problem size (guides, queries, ...), 0 if not applicable
+		int iterations = 0;
+		double meanMs = 0.0;
+		double medianMs = 0.0;
+		double minMs = 0.0;
+		double maxMs = 0.0;
+		double stddevMs = 0.0;
+		std::map<std::string, double> counters;
+	};
+
+	// Heap bytes allocated through operator new in this process; the harness replaces the global
+	// operator new/delete to count them. peakHeapBytes() is the high-water mark since resetPeakHeap().
+	size_t heapBytes();
+	size_t peakHeapBytes();
+	void resetPeakHeap();
+
+	class Harness {
+	public:
+		explicit Harness(const Options& options) : m_options(options) {}
+
+		bool wants(const std::string& name) const;
+
+		// Times body() repeatedly. setup() (optional) runs before every iteration and is not timed.
+		// Returns the stored result (valid until the next run), or nullptr if the case was filtered out.
+		Result* run(const std::string& name, int size, const std::function<void()>& body, const std::function<void()>& setup = {});
+
+		const std::vector<Result>& results() const { return m_results; }
+
+		bool writeJson(const std::string& path, const std::map<std::string, std::string>& meta) const;
+
+		// Compares against a previous JSON run. Prints per-case deltas and returns the number of
+		// cases whose median regressed by more than thresholdPct.
+		int compareWithBaseline(const std::string& baselinePath, double thresholdPct) const;
+
+	private:
+		Options m_options;
+		std::vector<Result> m_results;
+	};
+}
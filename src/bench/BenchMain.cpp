@@ -0,0 +1,693 @@
+// HairToolBench: headless benchmarks for the solver, BVH, import/export and serialization hot paths.
+//
+// Usage:
+//   HairToolBench [--mesh path.obj] [--out results.json] [--sizes 100,1000,5000] [--filter name]
+//                 [--min-time seconds] [--quick] [--baseline previous.json] [--threshold pct]
+
+#include "BenchHarness.h"
+
+#include "Scene.h"
+#include "Mesh.h"
+#include "Bvh.h"
+#include "Camera.h"
+#include "Physics.h"
+#include "MeshDistanceField.h"
+#include "ImportPly.h"
+#include "ExportPly.h"
+#include "Serialization.h"
+#include "GuideGenerator.h"
+#include "Parallel.h"
+#include "Raycast.h"
+#include "RootBinding.h"
+
+#include "HairToolVersion.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef HAIRTOOL_SAMPLE_DIR
+#define HAIRTOOL_SAMPLE_DIR "sample"
+#endif
+
+namespace {
+	struct BenchArgs {
+		std::string meshPath = std::string(HAIRTOOL_SAMPLE_DIR) + "/test_head.obj";
+		std::string outPath = "HairToolBench.json";
+		std::string baselinePath;
+		double thresholdPct = 10.0;
+		std::vector<int> sizes = {100, 1000, 5000};
+		int maxCurveCollisionGuides = 5000; // curve collision sorts every point into its grid each call
+		int maxLinearBindGuides = 10000;    // the linear duplicate scan is quadratic in the guide count
+		Bench::Options options;
+	};
+
+	static std::vector<int> parseSizes(const char* s) {
+		std::vector<int> out;
+		std::stringstream ss(s);
+		std::string tok;
+		while (std::getline(ss, tok, ',')) {
+			int v = std::atoi(tok.c_str());
+			if (v > 0) out.push_back(v);
+		}
+		return out;
+	}
+
+	static bool parseArgs(int argc, char** argv, BenchArgs& a) {
+		for (int i = 1; i < argc; i++) {
+			auto next = [&]() -> const char* { return (i + 1 < argc) ? argv[++i] : ""; };
+			if (!std::strcmp(argv[i], "--mesh")) a.meshPath = next();
+			else if (!std::strcmp(argv[i], "--out")) a.outPath = next();
+			else if (!std::strcmp(argv[i], "--sizes")) a.sizes = parseSizes(next());
+			else if (!std::strcmp(argv[i], "--filter")) a.options.filter = next();
+			else if (!std::strcmp(argv[i], "--min-time")) a.options.minSeconds = std::atof(next());
+			else if (!std::strcmp(argv[i], "--baseline")) a.baselinePath = next();
+			else if (!std::strcmp(argv[i], "--threshold")) a.thresholdPct = std::atof(next());
+			else if (!std::strcmp(argv[i], "--quick")) {
+				a.sizes = {100, 1000};
+				a.options.minSeconds = 0.1;
+			} else {
+				std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+				return false;
+			}
+		}
+		return !a.sizes.empty();
+	}
+
+	// Scatters guides uniformly by surface area with a fixed seed so every run sees the same groom.
+	static void scatterGuides(Scene& scene, int count, uint32_t seed) {
+		GuideGenerator::Params params;
+		params.count = count;
+		params.steps = scene.guideSettings().defaultSteps;
+		params.length = scene.guideSettings().defaultLength;
+		params.seed = seed;
+		GuideGenerator::scatter(scene, params);
+	}
+
+	static void selectAll(Scene& scene) {
+		for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) {
+			scene.guides().selectCurve((int)ci, true);
+		}
+	}
+
+	static std::vector<glm::vec3> randomPointsAround(const Mesh& mesh, int count, uint32_t seed) {
+		std::mt19937 rng(seed);
+		glm::vec3 bmin = mesh.boundsMin();
+		glm::vec3 bmax = mesh.boundsMax();
+		glm::vec3 pad = (bmax - bmin) * 0.1f;
+		std::uniform_real_distribution<float> dx(bmin.x - pad.x, bmax.x + pad.x);
+		std::uniform_real_distribution<float> dy(bmin.y - pad.y, bmax.y + pad.y);
+		std::uniform_real_distribution<float> dz(bmin.z - pad.z, bmax.z + pad.z);
+		std::vector<glm::vec3> out((size_t)count);
+		for (glm::vec3& p : out) p = glm::vec3(dx(rng), dy(rng), dz(rng));
+		return out;
+	}
+
+	static size_t totalPoints(const Scene& scene) {
+		size_t n = 0;
+		for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) n += scene.guides().curve(ci).points.size();
+		return n;
+	}
+
+	// Mean per-point distance between two guide sets with the same topology.
+	static double meanDeviation(const HairGuideSet& a, const HairGuideSet& b) {
+		double sum = 0.0;
+		size_t n = 0;
+		for (size_t ci = 0; ci < a.curveCount() && ci < b.curveCount(); ci++) {
+			const HairCurve& ca = a.curve(ci);
+			const HairCurve& cb = b.curve(ci);
+			for (size_t i = 0; i < ca.points.size() && i < cb.points.size(); i++) {
+				sum += (double)glm::length(ca.points[i] - cb.points[i]);
+				n++;
+			}
+		}
+		return (n > 0) ? sum / (double)n : 0.0;
+	}
+
+	// Per point (roots included): inside the mesh, by an odd number of surface crossings along +X.
+	static std::vector<char> pointsInsideMesh(const HairGuideSet& guides, const Bvh& bvh, const Mesh& mesh) {
+		const float outX = mesh.boundsMax().x + 1.0f;
+		std::vector<char> inside;
+		for (size_t ci = 0; ci < guides.curveCount(); ci++) {
+			for (glm::vec3 from : guides.curve(ci).points) {
+				const glm::vec3 to(outX, from.y, from.z);
+				int crossings = 0;
+				int tri = -1;
+				float t = 0.0f;
+				glm::vec3 n;
+				while (crossings < 64 && bvh.sweepSegment(from, to, tri, t, n)) {
+					crossings++;
+					from = from + (to - from) * t + glm::vec3(1e-5f, 0.0f, 0.0f);
+				}
+				inside.push_back((char)(crossings & 1));
+			}
+		}
+		return inside;
+	}
+}
+
+int main(int argc, char** argv) {
+	BenchArgs args;
+	if (!parseArgs(argc, argv, args)) return 2;
+
+	Scene scene;
+	if (!scene.loadMeshFromObj(args.meshPath)) {
+		std::fprintf(stderr, "Failed to load mesh %s\n", args.meshPath.c_str());
+		return 1;
+	}
+	const Mesh& mesh = *scene.mesh();
+	const int triCount = (int)mesh.indices().size() / 3;
+	std::printf("HairToolBench %s  mesh=%s  tris=%d\n\n", HAIRTOOL_VERSION_STRING, args.meshPath.c_str(), triCount);
+
+	Bench::Harness h(args.options);
+	const std::filesystem::path tmpDir = std::filesystem::temp_directory_path();
+
+	// --- BVH / distance field ---
+	{
+		Bvh bvh;
+		if (Bench::Result* r = h.run("bvh_build", triCount, [&]() { bvh.build(mesh); })) {
+			r->counters["triangles"] = triCount;
+		}
+		bvh.build(mesh);
+
+		Mesh topology = mesh;
+		if (Bench::Result* r = h.run("mesh_topology_build", triCount, [&]() { topology.buildTopology(); })) {
+			r->counters["bytes"] = (double)topology.topologyStats().bytes;
+			r->counters["open_edges"] = (double)topology.topologyStats().openEdges;
+		}
+
+		const int queryCount = 10000;
+		const std::vector<glm::vec3> pts = randomPointsAround(mesh, queryCount, 1234u);
+		const float thickness = scene.guideSettings().collisionThickness;
+		h.run("bvh_nearest_unbounded", queryCount, [&]() {
+			int tri = -1;
+			glm::vec3 cp, n;
+			for (const glm::vec3& p : pts) bvh.nearestTriangle(p, tri, cp, n);
+		});
+		h.run("bvh_nearest_collision_radius", queryCount, [&]() {
+			int tri = -1;
+			glm::vec3 cp, n;
+			for (const glm::vec3& p : pts) bvh.nearestTriangle(p, tri, cp, n, thickness * 2.0f);
+		});
+
+		// Collision-style queries: points hovering within the collision band over the surface, each moved
+		// by a small jitter per pass the way the solver's iterations move them. Same answers either way;
+		// the cached variant keeps one cache per point across passes.
+		{
+			const int passes = 12;
+			std::mt19937 rng(99u);
+			std::uniform_int_distribution<size_t> pickVertex(0, mesh.positions().size() - 1);
+			std::uniform_real_distribution<float> offset(0.5f * thickness, 1.5f * thickness);
+			std::normal_distribution<float> jitter(0.0f, 0.05f * thickness);
+			std::vector<glm::vec3> surfacePts((size_t)queryCount);
+			for (glm::vec3& p : surfacePts) {
+				const size_t v = pickVertex(rng);
+				p = mesh.positions()[v] + mesh.normals()[v] * offset(rng);
+			}
+			std::vector<std::vector<glm::vec3>> passPts((size_t)passes, surfacePts);
+			for (int k = 1; k < passes; k++) {
+				for (size_t i = 0; i < surfacePts.size(); i++) {
+					passPts[(size_t)k][i] = passPts[(size_t)k - 1][i] + glm::vec3(jitter(rng), jitter(rng), jitter(rng));
+				}
+			}
+			h.run("bvh_nearest_iterations", queryCount, [&]() {
+				int tri = -1;
+				glm::vec3 cp, n;
+				for (const std::vector<glm::vec3>& pts : passPts) {
+					for (const glm::vec3& p : pts) bvh.nearestTriangle(p, tri, cp, n, thickness * 2.0f);
+				}
+			});
+			std::vector<Bvh::NearestCache> caches;
+			int mismatches = 0;
+			if (Bench::Result* r = h.run("bvh_nearest_iterations_cached", queryCount, [&]() {
+				int tri = -1;
+				glm::vec3 cp, n;
+				for (const std::vector<glm::vec3>& pts : passPts) {
+					for (size_t i = 0; i < pts.size(); i++) bvh.nearestTriangleCached(pts[i], thickness * 2.0f, thickness, caches[i], tri, cp, n);
+				}
+			}, [&]() { caches.assign(surfacePts.size(), Bvh::NearestCache()); })) {
+				for (const std::vector<glm::vec3>& pts : passPts) {
+					for (size_t i = 0; i < pts.size(); i++) {
+						int triA = -1, triB = -1;
+						glm::vec3 cpA, nA, cpB, nB;
+						const bool hitA = bvh.nearestTriangle(pts[i], triA, cpA, nA, thickness * 2.0f);
+						const bool hitB = bvh.nearestTriangleCached(pts[i], thickness * 2.0f, thickness, caches[i], triB, cpB, nB);
+						// Compare distances: equidistant triangles may resolve either way.
+						if (hitA != hitB || (hitA && std::abs(glm::length(pts[i] - cpA) - glm::length(pts[i] - cpB)) > 1e-7f)) mismatches++;
+					}
+				}
+				r->counters["passes"] = passes;
+				r->counters["mismatches"] = mismatches;
+			}
+		}
+
+		const glm::vec3 center = 0.5f * (mesh.boundsMin() + mesh.boundsMax());
+		size_t candidates = 0;
+		if (Bench::Result* r = h.run("bvh_raycast", queryCount, [&]() {
+			candidates = 0;
+			for (const glm::vec3& p : pts) {
+				bvh.raycast(p, glm::normalize(center - p), [&](int) { candidates++; });
+			}
+		})) {
+			r->counters["candidates_per_ray"] = (double)candidates / (double)queryCount;
+		}
+
+		MeshDistanceField field;
+		h.run("distance_field_build", 48, [&]() { field.build(mesh, 48, 0.03f); });
+	}
+
+	// --- Strand stretch solve: Gauss-Seidel vs direct tridiagonal ---
+	// Guides of 12/32/64 segments start 0.5% longer than their rest length (a quick drag) (collisions and bending off), so
+	// the correction has to travel the whole strand. For each solver the case runs one step at the smallest
+	// power-of-two iteration count that brings the RMS stretch under 0.1%; counters report that count.
+	{
+		const float stepDt = 1.0f / 120.0f;
+		const float targetStretch = 0.001f;
+		GuideSettings& gs = scene.guideSettings();
+		const GuideSettings savedSettings = gs;
+		gs.enableMeshCollision = false;
+		gs.enableCurveCollision = false;
+		gs.stiffness = 0.0f;
+		gs.useXpbd = false;
+		gs.enableSleeping = false;
+		gs.gravity = 9.81f;
+		for (int steps : {12, 32, 64}) {
+			GuideGenerator::Params params;
+			params.count = 200;
+			params.steps = steps;
+			params.length = gs.defaultLength;
+			params.seed = 7u;
+			GuideGenerator::scatter(scene, params);
+			selectAll(scene);
+			for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) scene.guides().curve(ci).segmentRestLen /= 1.005f;
+			const HairGuideSet start = scene.guides();
+
+			for (int mode = 0; mode < 2; mode++) {
+				gs.directStretchSolve = (mode == 1);
+				int iters = 1;
+				Physics::StepStats stats;
+				for (;; iters *= 2) {
+					scene.guides() = start;
+					Physics::step(scene, stepDt, iters, &stats);
+					if (stats.stretchError <= targetStretch || iters >= 64) break;
+				}
+				const std::string name = gs.directStretchSolve ? "stretch_converge_direct" : "stretch_converge_gauss_seidel";
+				if (Bench::Result* r = h.run(name, steps, [&]() { Physics::step(scene, stepDt, iters, &stats); },
+					[&]() { scene.guides() = start; })) {
+					r->counters["guides"] = params.count;
+					r->counters["iterations_to_converge"] = iters;
+					r->counters["stretch_error_pct"] = stats.stretchError * 100.0;
+				}
+			}
+		}
+		gs = savedSettings;
+	}
+
+	// --- Bending model: second-neighbour distance vs rest-shape rod ---
+	// 200 guides of 24 segments are curled into helices, captured as their rest shape, then left to hang
+	// under gravity for half a second (collisions off). Counters report how far the strands drift from the
+	// styled shape and the residual stretch; the time is the cost of the whole run.
+	{
+		const float stepDt = 1.0f / 120.0f;
+		const int holdSteps = 60;
+		GuideSettings& gs = scene.guideSettings();
+		const GuideSettings savedSettings = gs;
+		gs.enableMeshCollision = false;
+		gs.enableCurveCollision = false;
+		gs.useXpbd = false;
+		gs.directStretchSolve = false;
+		gs.enableSleeping = false;
+		gs.gravity = 9.81f;
+
+		GuideGenerator::Params params;
+		params.count = 200;
+		params.steps = 25;
+		params.length = gs.defaultLength;
+		params.seed = 11u;
+		GuideGenerator::scatter(scene, params);
+		selectAll(scene);
+		const float pitch = 0.35f;      // segment tilt away from the root normal (rad)
+		const float twistStep = 0.5f;   // rotation about the normal per segment (rad)
+		for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) {
+			HairCurve& c = scene.guides().curve(ci);
+			glm::mat3 frame;
+			if (!HairGuideSet::rootFrame(c, mesh, frame)) continue;
+			for (size_t i = 1; i < c.points.size(); i++) {
+				const float a = twistStep * (float)i;
+				const glm::vec3 dir(std::sin(pitch) * std::cos(a), std::sin(pitch) * std::sin(a), std::cos(pitch));
+				c.points[i] = c.points[i - 1] + frame * dir * c.segmentRestLen;
+			}
+			c.prevPoints = c.points;
+			HairGuideSet::captureRestShape(c, mesh);
+		}
+		const HairGuideSet start = scene.guides();
+
+		for (int mode = 0; mode < 2; mode++) {
+			gs.rodBending = (mode == 1);
+			for (int iters : {4, 12}) {
+				Physics::StepStats stats;
+				const std::string name = gs.rodBending ? "bend_model_rod" : "bend_model_distance";
+				if (Bench::Result* r = h.run(name, iters, [&]() {
+					for (int s = 0; s < holdSteps; s++) {
+						Physics::step(scene, stepDt, iters, (s + 1 == holdSteps) ? &stats : nullptr);
+					}
+				}, [&]() { scene.guides() = start; })) {
+					r->counters["guides"] = params.count;
+					r->counters["iterations"] = iters;
+					r->counters["shape_deviation_mm"] = meanDeviation(scene.guides(), start) * 1000.0;
+					r->counters["stretch_error_pct"] = stats.stretchError * 100.0;
+				}
+			}
+		}
+		gs = savedSettings;
+	}
+
+	// --- Mesh collision: discrete pushout with substeps vs continuous collision ---
+	// 200 guides are flicked toward the head centre at 4 m/s and simulated for a quarter second. The
+	// discrete pushout only sees points that land within the collision band, so fast points end up inside
+	// unless the step is split into substeps; continuous collision sweeps every move instead. Cases are
+	// keyed by substeps per 1/120 s frame; counters report the points left inside the mesh.
+	{
+		const float frameDt = 1.0f / 120.0f;
+		const int frames = 30;
+		const float speed = 4.0f;
+		GuideSettings& gs = scene.guideSettings();
+		const GuideSettings savedSettings = gs;
+		gs.enableMeshCollision = true;
+		gs.enableCurveCollision = false;
+		gs.enableSleeping = false;
+		gs.gravity = 9.81f;
+
+		Bvh bvh;
+		bvh.build(mesh);
+		scatterGuides(scene, 200, 5u);
+		selectAll(scene);
+		const glm::vec3 center = 0.5f * (mesh.boundsMin() + mesh.boundsMax());
+		const HairGuideSet start = scene.guides();
+		// The scan also flags a few points that start inside (open mesh edges); only new ones count.
+		const std::vector<char> insideAtStart = pointsInsideMesh(start, bvh, mesh);
+
+		for (int mode = 0; mode < 2; mode++) {
+			gs.continuousCollision = (mode == 1);
+			for (int substeps : {1, 2, 4, 8}) {
+				if (gs.continuousCollision && substeps > 2) break;
+				const float dt = frameDt / (float)substeps;
+				auto flick = [&]() {
+					scene.guides() = start;
+					for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) {
+						HairCurve& c = scene.guides().curve(ci);
+						for (size_t i = 1; i < c.points.size(); i++) {
+							c.prevPoints[i] = c.points[i] - glm::normalize(center - c.points[i]) * (speed * dt);
+						}
+					}
+				};
+				const std::string name = gs.continuousCollision ? "mesh_collision_ccd" : "mesh_collision_discrete";
+				if (Bench::Result* r = h.run(name, substeps, [&]() {
+					for (int s = 0; s < frames * substeps; s++) Physics::step(scene, dt);
+				}, flick)) {
+					r->counters["substeps"] = substeps;
+					const std::vector<char> inside = pointsInsideMesh(scene.guides(), bvh, mesh);
+					int tunneled = 0;
+					for (size_t k = 0; k < inside.size() && k < insideAtStart.size(); k++) tunneled += (inside[k] && !insideAtStart[k]) ? 1 : 0;
+					r->counters["tunneled_points"] = tunneled;
+				}
+			}
+		}
+		gs = savedSettings;
+	}
+
+	// --- Size-dependent cases ---
+	const float fixedDt = 1.0f / 120.0f;
+	for (int size : args.sizes) {
+		scatterGuides(scene, size, 42u);
+		selectAll(scene);
+		const size_t points = totalPoints(scene);
+
+		GuideSettings& gs = scene.guideSettings();
+		gs.enableSimulation = true;
+		gs.enableMeshCollision = true;
+		gs.enableCurveCollision = false;
+		gs.enableSleeping = false; // the full solve; physics_step_settled measures sleeping
+		gs.gravity = 9.81f;
+
+		// Warm up so the solver runs in a steady, colliding state rather than on straight guides.
+		for (int i = 0; i < 10; i++) Physics::step(scene, fixedDt);
+		if (Bench::Result* r = h.run("physics_step", size, [&]() { Physics::step(scene, fixedDt); })) {
+			r->counters["particles"] = (double)points;
+			r->counters["iterations"] = gs.solverIterations;
+			r->counters["threads"] = Parallel::threadCount();
+		}
+
+		// Sleeping: let the guides hang for two seconds, then time a step of the settled groom with
+		// sleeping on. Counters report how many guides were skipped.
+		if (size == args.sizes.front()) {
+			const HairGuideSet start = scene.guides();
+			gs.enableSleeping = true;
+			Physics::StepStats stats;
+			for (int i = 0; i < 240; i++) Physics::step(scene, fixedDt);
+			const HairGuideSet settled = scene.guides();
+			if (Bench::Result* r = h.run("physics_step_settled", size, [&]() { Physics::step(scene, fixedDt, 0, &stats); },
+				[&]() { scene.guides() = settled; })) {
+				r->counters["sleeping"] = stats.sleepingCurves;
+				r->counters["awake"] = stats.simulatedCurves;
+			}
+			gs.enableSleeping = false;
+			scene.guides() = start;
+		}
+
+		// Convergence: PBD vs XPBD bending at equal iteration counts. Every run starts from the same state
+		// and simulates half a second; counters report the residual stretch after the last step and how far
+		// the guides end up from a 64-iteration reference of the same mode. Iteration-count independence
+		// shows up as a small deviation at low counts.
+		if (size == args.sizes.front()) {
+			const HairGuideSet start = scene.guides();
+			const int convergenceSteps = 60;
+			const int savedIterations = gs.solverIterations;
+			for (int mode = 0; mode < 2; mode++) {
+				gs.useXpbd = (mode == 1);
+				scene.guides() = start;
+				for (int s = 0; s < convergenceSteps; s++) Physics::step(scene, fixedDt, 64);
+				const HairGuideSet reference = scene.guides();
+
+				for (int iters : {2, 4, 8, 16}) {
+					Physics::StepStats stats;
+					const std::string name = gs.useXpbd ? "solver_convergence_xpbd" : "solver_convergence_pbd";
+					if (Bench::Result* r = h.run(name, iters, [&]() {
+						for (int s = 0; s < convergenceSteps; s++) {
+							Physics::step(scene, fixedDt, iters, (s + 1 == convergenceSteps) ? &stats : nullptr);
+						}
+					}, [&]() { scene.guides() = start; })) {
+						r->counters["iterations"] = iters;
+						r->counters["stretch_error_pct"] = stats.stretchError * 100.0;
+						r->counters["deviation_vs_64_mm"] = meanDeviation(scene.guides(), reference) * 1000.0;
+					}
+				}
+			}
+			gs.useXpbd = false;
+			gs.solverIterations = savedIterations;
+			scene.guides() = start;
+		}
+
+		if (size <= args.maxCurveCollisionGuides) {
+			gs.enableCurveCollision = true;
+			h.run("curve_curve_collision", size, [&]() { Physics::applyCurveCurveCollision(scene); });
+			gs.enableCurveCollision = false;
+		}
+
+		// ply_export/ply_import use the default binary format, the _ascii cases the text format.
+		// ply_import_ascii_serial parses on the calling thread only, for comparison with the chunked parse.
+		// ply_export_snapshot is the part of an app export that blocks the UI thread.
+		const std::string plyPath = (tmpDir / ("hairtool_bench_" + std::to_string(size) + ".ply")).string();
+		ExportPly::Snapshot exportSnapshot;
+		if (Bench::Result* r = h.run("ply_export_snapshot", size, [&]() { exportSnapshot = ExportPly::snapshotCurves(scene); })) {
+			r->counters["points"] = (double)exportSnapshot.points.size();
+		}
+		for (ExportPly::Format format : {ExportPly::Format::BinaryLittleEndian, ExportPly::Format::Ascii}) {
+			const std::string suffix = (format == ExportPly::Format::Ascii) ? "_ascii" : "";
+			if (Bench::Result* r = h.run("ply_export" + suffix, size, [&]() { ExportPly::exportCurvesAsPointCloud(scene, plyPath, format); })) {
+				r->counters["bytes"] = (double)std::filesystem::file_size(plyPath);
+			}
+			ExportPly::exportCurvesAsPointCloud(scene, plyPath, format);
+			ImportPly::ImportedCurves imported;
+			if (Bench::Result* r = h.run("ply_import" + suffix, size, [&]() { ImportPly::loadCurves(plyPath, imported); })) {
+				const double bytes = (double)std::filesystem::file_size(plyPath);
+				r->counters["bytes"] = bytes;
+				r->counters["curves"] = (double)imported.curveCount();
+				r->counters["mb_per_s"] = bytes / (r->medianMs * 1e-3) / 1e6;
+				r->counters["threads"] = Parallel::threadCount();
+			}
+			if (format != ExportPly::Format::Ascii) continue;
+			if (Bench::Result* r = h.run("ply_import_ascii_serial", size, [&]() { ImportPly::loadCurves(plyPath, imported, nullptr, nullptr, nullptr, false); })) {
+				const double bytes = (double)std::filesystem::file_size(plyPath);
+				r->counters["bytes"] = bytes;
+				r->counters["mb_per_s"] = bytes / (r->medianMs * 1e-3) / 1e6;
+			}
+		}
+
+		// Curve import into a groom of the same size: every imported root is bound to the mesh and matched
+		// against the existing roots, and every other one duplicates an existing root. The _linear case is
+		// the per-root query plus scan over all existing roots that the import used before.
+		{
+			const float dupTol = std::max(0.0005f, gs.collisionThickness * 0.5f);
+			const float maxBindDist = std::max(0.005f, gs.collisionThickness * 2.0f);
+			std::vector<glm::vec3> existing;
+			for (size_t ci = 0; ci < scene.guides().curveCount(); ci++) existing.push_back(scene.guides().curve(ci).points[0]);
+			std::mt19937 rng(7u);
+			std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+			std::vector<glm::vec3> incoming(existing.size());
+			for (size_t i = 0; i < existing.size(); i++) {
+				const glm::vec3 dir = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)) + glm::vec3(1e-3f));
+				incoming[i] = existing[i] + dir * ((i % 2 == 0) ? 0.3f * dupTol : 4.0f * dupTol);
+			}
+
+			// Per imported root: the claimed existing root, -1 for none, -2 if it didn't bind.
+			std::vector<int> batched;
+			auto bindBatched = [&]() {
+				std::vector<RayHit> hits;
+				RootBinding::bindRoots(mesh, *scene.meshBvh(), incoming, maxBindDist, hits);
+				RootBinding::DuplicateIndex duplicates;
+				duplicates.build(existing, dupTol);
+				batched.assign(incoming.size(), -2);
+				for (size_t i = 0; i < incoming.size(); i++) {
+					if (hits[i].hit && hits[i].triIndex >= 0) batched[i] = duplicates.claim(hits[i].position);
+				}
+			};
+			if (Bench::Result* r = h.run("import_bind_roots", size, bindBatched)) {
+				r->counters["duplicates"] = (double)std::count_if(batched.begin(), batched.end(), [](int d) { return d >= 0; });
+				r->counters["threads"] = Parallel::threadCount();
+			}
+
+			std::vector<int> linear;
+			auto bindLinear = [&]() {
+				std::vector<char> claimed(existing.size(), 0);
+				linear.assign(incoming.size(), -2);
+				for (size_t i = 0; i < incoming.size(); i++) {
+					RayHit hit;
+					if (!Raycast::nearestOnMesh(mesh, incoming[i], hit, maxBindDist) || !hit.hit || hit.triIndex < 0) continue;
+					linear[i] = -1;
+					for (size_t e = 0; e < existing.size(); e++) {
+						if (claimed[e] || glm::length(existing[e] - hit.position) > dupTol) continue;
+						claimed[e] = 1;
+						linear[i] = (int)e;
+						break;
+					}
+				}
+			};
+			if (size <= args.maxLinearBindGuides) {
+				if (Bench::Result* r = h.run("import_bind_roots_linear", size, bindLinear)) {
+					if (batched.empty()) bindBatched();
+					int mismatches = 0;
+					for (size_t i = 0; i < incoming.size(); i++) mismatches += (batched[i] != linear[i]) ? 1 : 0;
+					r->counters["mismatches"] = mismatches;
+				}
+			}
+		}
+
+		// JSON scenes: the streaming writer/reader and the JsonCpp DOM path it replaced (_dom). peak_mb is
+		// the heap high-water mark above the starting point of one extra, untimed call.
+		Camera camera;
+		const std::string scenePath = (tmpDir / ("hairtool_bench_" + std::to_string(size) + ".json")).string();
+		auto peakMb = [](const std::function<void()>& body) {
+			const size_t before = Bench::heapBytes();
+			Bench::resetPeakHeap();
+			body();
+			return (double)(Bench::peakHeapBytes() - before) / (1024.0 * 1024.0);
+		};
+		// Note: loading re-imports the OBJ referenced by the scene, exactly like the app does.
+		Scene loaded;
+		for (bool dom : {false, true}) {
+			const std::string suffix = dom ? "_dom" : "";
+			auto save = [&]() {
+				if (dom) Serialization::saveSceneJsonDom(scene, camera, scenePath);
+				else Serialization::saveSceneJson(scene, camera, scenePath);
+			};
+			auto load = [&](Scene& into) {
+				if (dom) Serialization::loadSceneJsonDom(into, nullptr, scenePath);
+				else Serialization::loadScene(into, nullptr, scenePath);
+			};
+			if (Bench::Result* r = h.run("scene_save_json" + suffix, size, save)) {
+				r->counters["bytes"] = (double)std::filesystem::file_size(scenePath);
+				r->counters["peak_mb"] = peakMb(save);
+			}
+			if (Bench::Result* r = h.run("scene_load_json" + suffix, size, [&]() { load(loaded); })) {
+				int mismatches = (loaded.guides().curveCount() == scene.guides().curveCount()) ? 0 : 1;
+				for (size_t ci = 0; mismatches == 0 && ci < scene.guides().curveCount(); ci++) {
+					if (loaded.guides().curve(ci).points != scene.guides().curve(ci).points) mismatches++;
+				}
+				r->counters["mismatches"] = mismatches;
+				r->counters["peak_mb"] = peakMb([&]() {
+					Scene fresh;
+					load(fresh);
+				});
+			}
+		}
+
+		// Binary scenes, deflated (the default) and raw. mismatches counts curves whose points or binding
+		// didn't survive the round trip.
+		const std::string binaryPath = (tmpDir / ("hairtool_bench_" + std::to_string(size) + ".hts")).string();
+		for (bool compress : {true, false}) {
+			const std::string suffix = compress ? "" : "_raw";
+			if (Bench::Result* r = h.run("scene_save_binary" + suffix, size, [&]() { Serialization::saveSceneBinary(scene, camera, binaryPath, compress); })) {
+				r->counters["bytes"] = (double)std::filesystem::file_size(binaryPath);
+			}
+			if (Bench::Result* r = h.run("scene_load_binary" + suffix, size, [&]() { Serialization::loadScene(loaded, nullptr, binaryPath); })) {
+				int mismatches = (loaded.guides().curveCount() == scene.guides().curveCount()) ? 0 : 1;
+				for (size_t ci = 0; mismatches == 0 && ci < scene.guides().curveCount(); ci++) {
+					const HairCurve& a = scene.guides().curve(ci);
+					const HairCurve& b = loaded.guides().curve(ci);
+					if (a.points != b.points || a.root.triIndex != b.root.triIndex || a.restLocal != b.restLocal) mismatches++;
+				}
+				r->counters["mismatches"] = mismatches;
+			}
+		}
+
+		// Autosave's UI-thread cost: copying the scene into a reused snapshot. The write runs on a worker
+		// after hashing the snapshot to skip unchanged scenes.
+		Serialization::SceneSnapshot autosaveSnapshot;
+		if (Bench::Result* r = h.run("scene_snapshot", size, [&]() { Serialization::snapshotScene(scene, camera, autosaveSnapshot); })) {
+			r->counters["points"] = (double)autosaveSnapshot.points.size();
+		}
+		uint64_t snapshotHash = 0;
+		h.run("scene_snapshot_hash", size, [&]() { snapshotHash = autosaveSnapshot.hash(); });
+
+		std::error_code ec;
+		std::filesystem::remove(plyPath, ec);
+		std::filesystem::remove(scenePath, ec);
+		std::filesystem::remove(binaryPath, ec);
+	}
+
+	std::map<std::string, std::string> meta;
+	meta["tool"] = "HairToolBench";
+	meta["version"] = HAIRTOOL_VERSION_STRING;
+	meta["mesh"] = args.meshPath;
+	meta["triangles"] = std::to_string(triCount);
+	meta["hardware_threads"] = std::to_string(std::thread::hardware_concurrency());
+#if defined(NDEBUG)
+	meta["build"] = "release";
+#else
+	meta["build"] = "debug";
+#endif
+	if (!h.writeJson(args.outPath, meta)) {
+		std::fprintf(stderr, "Failed to write %s\n", args.outPath.c_str());
+		return 1;
+	}
+	std::printf("\nWrote %s\n", args.outPath.c_str());
+
+	if (!args.baselinePath.empty()) {
+		int regressions = h.compareWithBaseline(args.baselinePath, args.thresholdPct);
+		if (regressions > 0) return 3;
+	}
+	return 0;
+}
@@ -17,6 +17,7 @@
 #include <glm/glm.hpp>
 
 #include "Log.h"
+#include "Trace.h"
 
 static inline void checkCuda(cudaError_t err, const char* msg) {
 	if (err == cudaSuccess) return;
@@ -225,6 +226,7 @@ __global__ void meshCollisionKernel(float* pos, const int* curveOffsets, const i
 }
 
 void CudaHairSolver::step(Scene& scene, float dt) {
+	HT_TRACE_SCOPE("CudaHairSolver::step");
 	if (!m_ready) init();
 	if (!scene.mesh()) return;
 	ensureFieldUploaded(scene);
@@ -235,11 +237,15 @@ void CudaHairSolver::step(Scene& scene, float dt) {
 	// Keep roots attached
 	guides.updatePinnedRootsFromMesh(*scene.mesh());
 
-	// Pack only selected curves (freeze unselected curves)
+	const bool tracing = Trace::enabled();
+	if (tracing) Trace::begin("CudaHairSolver::pack");
+
+	// Pack only the simulated curves (the selection, or every curve on a simulated layer with Simulate All);
+	// the rest stay frozen, as on the CPU path.
 	std::vector<int> curveMap;
 	curveMap.reserve(guides.curveCount());
 	for (size_t i = 0; i < guides.curveCount(); i++) {
-		if (guides.isCurveSelected(i)) curveMap.push_back((int)i);
+		if (scene.isCurveSimulated(i)) curveMap.push_back((int)i);
 	}
 
 	m_curveCount = (int)curveMap.size();
@@ -276,6 +282,11 @@ void CudaHairSolver::step(Scene& scene, float dt) {
 			if (i == 0) m_h_pinned[(size_t)(base + i)] = (unsigned char)1;
 		}
 	}
+	if (tracing) {
+		Trace::end("CudaHairSolver::pack");
+		Trace::counter("gpu_particles", (double)totalParticles);
+		Trace::begin("CudaHairSolver::upload");
+	}
 
 	checkCuda(cudaMemcpy(m_d_pos, m_h_pos.data(), m_h_pos.size() * sizeof(float), cudaMemcpyHostToDevice), "H2D pos");
 	checkCuda(cudaMemcpy(m_d_prev, m_h_prev.data(), m_h_prev.size() * sizeof(float), cudaMemcpyHostToDevice), "H2D prev");
@@ -283,6 +294,10 @@ void CudaHairSolver::step(Scene& scene, float dt) {
 	checkCuda(cudaMemcpy(m_d_curveCounts, m_h_curveCounts.data(), m_h_curveCounts.size() * sizeof(int), cudaMemcpyHostToDevice), "H2D counts");
 	checkCuda(cudaMemcpy(m_d_restLen, m_h_restLen.data(), m_h_restLen.size() * sizeof(float), cudaMemcpyHostToDevice), "H2D restLen");
 	checkCuda(cudaMemcpy(m_d_pinned, m_h_pinned.data(), m_h_pinned.size() * sizeof(unsigned char), cudaMemcpyHostToDevice), "H2D pinned");
+	if (tracing) {
+		Trace::end("CudaHairSolver::upload");
+		Trace::begin("CudaHairSolver::kernels");
+	}
 
 	// Roots are marked as pinned; integrate/damping kernels will skip them.
 
@@ -322,6 +337,10 @@ void CudaHairSolver::step(Scene& scene, float dt) {
 	dampingKernel<<<blocks, threads>>>((float*)m_d_pos, (float*)m_d_prev, (const unsigned char*)m_d_pinned, totalParticles, 0.98f);
 	checkCudaKernel("dampingKernel");
 	checkCuda(cudaDeviceSynchronize(), "sync");
+	if (tracing) {
+		Trace::end("CudaHairSolver::kernels");
+		Trace::begin("CudaHairSolver::download");
+	}
 
 	// Download
 	checkCuda(cudaMemcpy(m_h_pos.data(), m_d_pos, m_h_pos.size() * sizeof(float), cudaMemcpyDeviceToHost), "D2H pos");	
@@ -344,6 +363,7 @@ void CudaHairSolver::step(Scene& scene, float dt) {
 			);
 		}
 	}
+	if (tracing) Trace::end("CudaHairSolver::download");
 
 	// Optional curve-curve collision remains CPU for now (mesh collision is on GPU).
 	Physics::applyCurveCurveCollision(scene);
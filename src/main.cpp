@@ -2,8 +2,24 @@
 #include "MayaCameraController.h"
 #include "Scene.h"
 #include "Renderer.h"
+#include "GuideGenerator.h"
+#include "Trace.h"
+
+#include <cstring>
+
+int main(int argc, char** argv) {
+	// Headless stress-scene generation: HairTool --generate out.hts|out.json [options]
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--generate") == 0) return GuideGenerator::runCommandLine(argc, argv);
+	}
+	// --trace <file.json>: record trace events from startup and write them on exit.
+	for (int i = 1; i + 1 < argc; i++) {
+		if (std::strcmp(argv[i], "--trace") == 0) {
+			Trace::setExitPath(argv[i + 1]);
+			Trace::setEnabled(true);
+		}
+	}
 
-int main() {
 	App app;
 	if (!app.init()) return 1;
 	app.run();